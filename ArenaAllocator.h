@@ -0,0 +1,346 @@
+// -------------------------------
+// projects/deque/ArenaAllocator.h
+// -------------------------------
+
+#ifndef ArenaAllocator_h
+#define ArenaAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef> // ptrdiff_t, size_t
+#include <cstdlib> // free, posix_memalign
+#include <new>     // bad_alloc, new
+#include <vector>  // vector
+
+#include <sched.h>    // sched_yield
+#include <stdint.h>   // uintptr_t
+#include <sys/mman.h> // madvise, mmap, munmap
+
+// ----------
+// BlockArena
+// ----------
+
+/**
+ * A pool of cache-line-aligned chunks carved from 2 MB arenas.
+ * Each arena is aligned to 2 MB and madvised as a transparent huge page, so a
+ * Deque's blocks share a few TLB entries instead of one per 4 KB page. Chunks
+ * are rounded up to a multiple of the cache line, so no block straddles a line
+ * it doesn't need and no two deques' blocks share a line.
+ * Freed chunks go on a free list per size and are reused;
+ * arenas are kept for the life of the process, so deques that outlive main
+ * can still free into them.
+ * Chunks too large for a size class come from posix_memalign, and chunks of
+ * 2 MB or more, such as the outer array of a large Deque, are mapped as huge
+ * pages of their own.
+ * A chunk carved from a fresh arena hasn't been touched, so it is still zero
+ * pages; allocate reports that, and a Deque filled with zeros skips writing it.
+ * The free lists and the current arena are guarded by a spin lock, so deques on
+ * different threads can share the pool; new arenas are mapped outside the lock.
+ */
+class BlockArena {
+    public:
+        enum {
+            ARENA_BYTES = 2 << 20,
+            LINE_BYTES  = 64,
+            CLASSES     = 64};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        char* _next;
+
+        char* _end;
+
+        /**
+         * the arenas, kept outside them so they stay reachable without touching their pages
+         */
+        std::vector<char*> _arenas;
+
+        /**
+         * for each size in lines, a list of free chunks linked through their first word
+         */
+        void* _free[CLASSES + 1];
+
+        /**
+         * 1 while a thread is using _next, _end, _arenas, or _free
+         */
+        volatile int _lock;
+
+    private:
+        // ----
+        // Lock
+        // ----
+
+        /**
+         * holds the pool's spin lock for its lifetime
+         */
+        class Lock {
+            private:
+                volatile int& _lock;
+
+                Lock (const Lock&);
+
+                Lock& operator = (const Lock&);
+
+            public:
+                explicit Lock (volatile int& lock) : _lock(lock) {
+                    while (__sync_lock_test_and_set(&_lock, 1))
+                        sched_yield();}
+
+                ~Lock () {
+                    __sync_lock_release(&_lock);}};
+
+    private:
+        // ---
+        // map
+        // ---
+
+        /**
+         * @param bytes a multiple of 2 MB
+         * @return a 2 MB-aligned region of that size, madvised as huge pages
+         * @throws bad_alloc if the system is out of memory
+         */
+        static char* map (std::size_t bytes) {
+            void* const m = mmap(0, bytes + ARENA_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (m == MAP_FAILED)
+                throw std::bad_alloc();
+            char* const b = static_cast<char*>(m);
+            char* const a = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(b) + ARENA_BYTES - 1) & ~uintptr_t(ARENA_BYTES - 1));
+            if (a != b)
+                munmap(b, a - b);
+            munmap(a + bytes, b + ARENA_BYTES - a);
+#ifdef MADV_HUGEPAGE
+            madvise(a, bytes, MADV_HUGEPAGE);
+#endif
+            return a;}
+
+        // ----
+        // take
+        // ----
+
+        /**
+         * @param lines the size of the chunk in lines
+         * @param spare an arena mapped by the caller, or 0; if the current arena is too full,
+         *              carving moves on to spare, and spare is set to 0
+         * @param zeroed set to true if the chunk is untouched zero pages
+         * @return a chunk from the free list or the current arena, or 0 if a new arena is needed
+         */
+        void* take (std::size_t lines, char*& spare, bool& zeroed) {
+            Lock l(_lock);
+            if (_free[lines] != 0) {
+                void* const p = _free[lines];
+                _free[lines] = *static_cast<void**>(p);
+                return p;}
+            if ((std::size_t(_end - _next) < lines * LINE_BYTES) && (spare != 0)) {
+                _arenas.push_back(spare);
+                _next = spare;
+                _end  = spare + ARENA_BYTES;
+                spare = 0;}
+            if (std::size_t(_end - _next) < lines * LINE_BYTES)
+                return 0;
+            void* const p = _next;
+            _next += lines * LINE_BYTES;
+            zeroed = true;
+            return p;}
+
+        BlockArena (const BlockArena&);
+
+        BlockArena& operator = (const BlockArena&);
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        BlockArena () : _next(0), _end(0), _arenas(), _lock(0) {
+            for (int c = 0; c <= CLASSES; ++c)
+                _free[c] = 0;}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param bytes  the size of the chunk
+         * @param zeroed set to true if the chunk is untouched zero pages, false if it was used before
+         * @return a chunk aligned to a cache line
+         * @throws bad_alloc if the system is out of memory
+         */
+        void* allocate (std::size_t bytes, bool& zeroed) {
+            const std::size_t lines = (bytes + LINE_BYTES - 1) / LINE_BYTES + (bytes == 0);
+            zeroed = false;
+            if (bytes >= std::size_t(ARENA_BYTES)) {
+                zeroed = true;
+                return map((bytes + ARENA_BYTES - 1) & ~std::size_t(ARENA_BYTES - 1));}
+            if (lines > std::size_t(CLASSES)) {
+                void* p = 0;
+                if (posix_memalign(&p, LINE_BYTES, lines * LINE_BYTES) != 0)
+                    throw std::bad_alloc();
+                return p;}
+            char* spare = 0;
+            void* p     = 0;
+            try {
+                while ((p = take(lines, spare, zeroed)) == 0)
+                    spare = map(ARENA_BYTES);}
+            catch (...) {
+                if (spare != 0)
+                    munmap(spare, ARENA_BYTES);
+                throw;}
+            if (spare != 0)
+                munmap(spare, ARENA_BYTES);
+            return p;}
+
+        /**
+         * @param bytes the size of the chunk
+         * @return a chunk aligned to a cache line
+         * @throws bad_alloc if the system is out of memory
+         */
+        void* allocate (std::size_t bytes) {
+            bool zeroed;
+            return allocate(bytes, zeroed);}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        /**
+         * @param p     a chunk from allocate
+         * @param bytes the size it was allocated with
+         */
+        void deallocate (void* p, std::size_t bytes) {
+            const std::size_t lines = (bytes + LINE_BYTES - 1) / LINE_BYTES + (bytes == 0);
+            if (bytes >= std::size_t(ARENA_BYTES)) {
+                munmap(p, (bytes + ARENA_BYTES - 1) & ~std::size_t(ARENA_BYTES - 1));
+                return;}
+            if (lines > std::size_t(CLASSES)) {
+                std::free(p);
+                return;}
+            Lock l(_lock);
+            *static_cast<void**>(p) = _free[lines];
+            _free[lines] = p;}
+
+        // --------
+        // instance
+        // --------
+
+        /**
+         * @return the pool shared by every ArenaAllocator
+         * it is made on first use and never destroyed, so deques that outlive main can still free into it
+         */
+        static BlockArena& instance () {
+            static BlockArena* const a = new BlockArena;
+            return *a;}};
+
+// --------------
+// ArenaAllocator
+// --------------
+
+/**
+ * An allocator whose chunks come from BlockArena, for use as Deque's A.
+ * All ArenaAllocators share one pool, so any one can free another's chunks.
+ */
+template <typename T>
+class ArenaAllocator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+
+        template <typename U>
+        struct rebind {
+            typedef ArenaAllocator<U> other;};
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        friend bool operator == (const ArenaAllocator&, const ArenaAllocator&) {
+            return true;}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        ArenaAllocator () {}
+
+        template <typename U>
+        ArenaAllocator (const ArenaAllocator<U>&) {}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -------
+        // address
+        // -------
+
+        pointer address (reference x) const {
+            return &x;}
+
+        const_pointer address (const_reference x) const {
+            return &x;}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param n the number of elements
+         * @return uninitialized space for n elements, aligned to a cache line
+         */
+        pointer allocate (size_type n, const void* = 0) {
+            return static_cast<pointer>(BlockArena::instance().allocate(n * sizeof(T)));}
+
+        // ---------
+        // construct
+        // ---------
+
+        void construct (pointer p, const_reference v) {
+            new (p) T(v);}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (pointer p, size_type n) {
+            BlockArena::instance().deallocate(p, n * sizeof(T));}
+
+        // -------
+        // destroy
+        // -------
+
+        void destroy (pointer p) {
+            p->~T();}
+
+        // --------
+        // max_size
+        // --------
+
+        size_type max_size () const {
+            return size_type(-1) / sizeof(T);}};
+
+// ---------------
+// allocate_zeroed
+// ---------------
+
+/**
+ * @param zeroed set to true if the space is untouched zero pages
+ * @return uninitialized space for n elements from the arena of a
+ */
+template <typename T>
+T* allocate_zeroed (ArenaAllocator<T>&, std::size_t n, bool& zeroed) {
+    return static_cast<T*>(BlockArena::instance().allocate(n * sizeof(T), zeroed));}
+
+#endif // ArenaAllocator_h
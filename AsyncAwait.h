@@ -0,0 +1,178 @@
+// ---------------------------
+// projects/deque/AsyncAwait.h
+// ---------------------------
+
+#ifndef AsyncAwait_h
+#define AsyncAwait_h
+
+#if __cplusplus <= 201703L
+#error "AsyncAwait.h needs C++20 coroutines; build it with -std=c++20"
+#endif
+
+// --------
+// includes
+// --------
+
+#include <coroutine> // coroutine_handle, suspend_never
+#include <exception> // terminate
+
+#include "AsyncDeque.h"
+
+// -----
+// Stage
+// -----
+
+/**
+ * The return type of a pipeline stage written as a coroutine.
+ * A stage starts running at once, suspends at each co_await that can't
+ * complete, and frees its own frame when it returns. An exception that
+ * escapes a stage terminates the program.
+ */
+struct Stage {
+    struct promise_type {
+        Stage get_return_object () {
+            return Stage();}
+
+        std::suspend_never initial_suspend () noexcept {
+            return std::suspend_never();}
+
+        std::suspend_never final_suspend () noexcept {
+            return std::suspend_never();}
+
+        void return_void () {}
+
+        void unhandled_exception () {
+            std::terminate();}};};
+
+// ----------
+// PopAwaiter
+// ----------
+
+/**
+ * What co_await async_pop_front(q) waits on.
+ * If q holds an item, the stage takes it without suspending; otherwise the
+ * awaiter parks itself as the stage's continuation, and the executor resumes
+ * the stage once a producer has written an item into it.
+ */
+template <typename T, typename A>
+class PopAwaiter : public Continuation {
+    private:
+        // ----
+        // data
+        // ----
+
+        AsyncDeque<T, A>& _queue;
+
+        T _slot;
+
+        std::coroutine_handle<> _handle;
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        explicit PopAwaiter (AsyncDeque<T, A>& q) : _queue(q), _slot(), _handle() {}
+
+        PopAwaiter (const PopAwaiter&) = delete;
+
+        PopAwaiter& operator = (const PopAwaiter&) = delete;
+
+        // ---------
+        // awaitable
+        // ---------
+
+        bool await_ready () {
+            return !_queue.empty() && _queue.pop_front(_slot, *this);}
+
+        bool await_suspend (std::coroutine_handle<> h) {
+            _handle = h;
+            return !_queue.pop_front(_slot, *this);}
+
+        T await_resume () {
+            return _slot;}
+
+        // ------
+        // resume
+        // ------
+
+        void resume () {
+            _handle.resume();}};
+
+// -----------
+// PushAwaiter
+// -----------
+
+/**
+ * What co_await async_push_back(q, v) waits on.
+ * If q has room, v goes in without suspending; otherwise the awaiter parks
+ * v and itself, and the executor resumes the stage once a consumer has made
+ * room and v has been accepted.
+ */
+template <typename T, typename A>
+class PushAwaiter : public Continuation {
+    private:
+        // ----
+        // data
+        // ----
+
+        AsyncDeque<T, A>& _queue;
+
+        T _value;
+
+        std::coroutine_handle<> _handle;
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        PushAwaiter (AsyncDeque<T, A>& q, const T& v) : _queue(q), _value(v), _handle() {}
+
+        PushAwaiter (const PushAwaiter&) = delete;
+
+        PushAwaiter& operator = (const PushAwaiter&) = delete;
+
+        // ---------
+        // awaitable
+        // ---------
+
+        bool await_ready () {
+            return (_queue.size() < _queue.bound()) && _queue.push_back(_value, *this);}
+
+        bool await_suspend (std::coroutine_handle<> h) {
+            _handle = h;
+            return !_queue.push_back(_value, *this);}
+
+        void await_resume () {}
+
+        // ------
+        // resume
+        // ------
+
+        void resume () {
+            _handle.resume();}};
+
+// ---------------
+// async_pop_front
+// ---------------
+
+/**
+ * @return an awaitable whose co_await yields the oldest item of q, suspending while q is empty
+ */
+template <typename T, typename A>
+PopAwaiter<T, A> async_pop_front (AsyncDeque<T, A>& q) {
+    return PopAwaiter<T, A>(q);}
+
+// ---------------
+// async_push_back
+// ---------------
+
+/**
+ * @return an awaitable whose co_await adds v to q, suspending while q is full
+ */
+template <typename T, typename A>
+PushAwaiter<T, A> async_push_back (AsyncDeque<T, A>& q, const T& v) {
+    return PushAwaiter<T, A>(q, v);}
+
+#endif // AsyncAwait_h
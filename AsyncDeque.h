@@ -0,0 +1,337 @@
+// ---------------------------
+// projects/deque/AsyncDeque.h
+// ---------------------------
+
+#ifndef AsyncDeque_h
+#define AsyncDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert> // assert
+#include <memory>  // allocator
+#include <utility> // pair
+
+#include "Deque.h"
+
+// ------------
+// Continuation
+// ------------
+
+/**
+ * The rest of a suspended stage.
+ * resume() runs it until it finishes or suspends again.
+ */
+class Continuation {
+    public:
+        virtual ~Continuation () {}
+
+        virtual void resume () = 0;};
+
+// --------
+// Executor
+// --------
+
+/**
+ * A single-threaded run queue of continuations that are ready to resume.
+ */
+class Executor {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef Deque<Continuation*>     queue_type;
+        typedef queue_type::size_type    size_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        queue_type _ready;
+
+    public:
+        // ----
+        // post
+        // ----
+
+        /**
+         * @param k the continuation to resume on a later turn
+         */
+        void post (Continuation& k) {
+            _ready.push_back(&k);}
+
+        /**
+         * @param batch the continuations to resume, in order, on later turns; it is left empty
+         * swaps batch in when nothing else is ready, and otherwise appends it a continuation
+         * at a time, in O(batch.size()), which resuming them costs anyway; either way batch
+         * keeps an inner array, so a caller that reuses it doesn't allocate on every post
+         */
+        void post (queue_type& batch) {
+            if (_ready.empty())
+                _ready.swap(batch);
+            else
+                while (!batch.empty()) {
+                    _ready.push_back(batch.front());
+                    batch.pop_front();}}
+
+        // ---
+        // run
+        // ---
+
+        /**
+         * resumes continuations until none are ready
+         * @return the number resumed
+         */
+        size_type run () {
+            size_type n = 0;
+            while (!_ready.empty()) {
+                Continuation* const k = _ready.front();
+                _ready.pop_front();
+                k->resume();
+                ++n;}
+            return n;}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return true if no continuation is ready
+         */
+        bool empty () const {
+            return _ready.empty();}};
+
+// ----------
+// AsyncDeque
+// ----------
+
+/**
+ * A bounded queue between stages that suspend instead of blocking a thread.
+ * pop_front and push_back follow the shape of an awaitable: they return true
+ * if they completed at once, or false after parking the caller's continuation,
+ * which the executor resumes once the operation has completed.
+ * Wakeups are batched: one call that frees items or space hands them to every
+ * waiter it can satisfy and posts all of their continuations to the executor
+ * at once, through one batch that is reused from call to call.
+ * AsyncAwait.h wraps pop_front and push_back as C++20 awaitables.
+ * An AsyncDeque and its executor belong to one thread.
+ */
+template < typename T, typename A = std::allocator<T> >
+class AsyncDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::const_reference const_reference;
+
+        typedef std::pair<value_type*, Continuation*>    consumer_type;
+        typedef std::pair<value_type,  Continuation*>    producer_type;
+
+        typedef typename allocator_type::template rebind<consumer_type>::other consumer_allocator_type;
+        typedef typename allocator_type::template rebind<producer_type>::other producer_allocator_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Executor& _executor;
+
+        size_type _bound;
+
+        Deque<value_type, allocator_type> _items;
+
+        Deque<consumer_type, consumer_allocator_type> _consumers;
+
+        Deque<producer_type, producer_allocator_type> _producers;
+
+        /**
+         * the continuations completed by one call, posted together
+         */
+        Executor::queue_type _batch;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_bound != 0)
+                && (_items.size() <= _bound)
+                && (_consumers.empty() || _items.empty())
+                && (_producers.empty() || _items.size() == _bound);}
+
+        // ----
+        // wake
+        // ----
+
+        /**
+         * hands items to waiting consumers and space to waiting producers
+         * until neither can move, then posts every continuation it completed
+         */
+        void wake () {
+            for (;;) {
+                if (!_items.empty() && !_consumers.empty()) {
+                    *_consumers.front().first = _items.front();
+                    _items.pop_front();
+                    _batch.push_back(_consumers.front().second);
+                    _consumers.pop_front();}
+                else if ((_items.size() < _bound) && !_producers.empty()) {
+                    _items.push_back(_producers.front().first);
+                    _batch.push_back(_producers.front().second);
+                    _producers.pop_front();}
+                else
+                    break;}
+            if (!_batch.empty())
+                _executor.post(_batch);
+            assert(valid());}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param e the executor that resumes suspended stages
+         * @param b the most items held before push_back suspends; must be positive
+         * @param a the allocator for the items
+         */
+        AsyncDeque (Executor& e, size_type b, const allocator_type& a = allocator_type()) :
+                _executor(e),
+                _bound(b),
+                _items(a),
+                _consumers(consumer_allocator_type(a)),
+                _producers(producer_allocator_type(a)) {
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * drops the items; stages still parked are never resumed
+         */
+        ~AsyncDeque () {
+            assert(valid());}
+
+    private:
+        AsyncDeque (const AsyncDeque&);
+
+        AsyncDeque& operator = (const AsyncDeque&);
+
+    public:
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * @param slot where the oldest item is written; it must live until k resumes
+         * @param k    the continuation to resume once slot is written, if the queue is empty
+         * @return true if slot was written now, false if k was parked
+         */
+        bool pop_front (value_type& slot, Continuation& k) {
+            if (_items.empty()) {
+                _consumers.push_back(consumer_type(&slot, &k));
+                assert(valid());
+                return false;}
+            slot = _items.front();
+            _items.pop_front();
+            wake();
+            return true;}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v the item to add
+         * @param k the continuation to resume once v is accepted, if the queue is full
+         * @return true if v was accepted now, false if v is held and k was parked
+         */
+        bool push_back (const_reference v, Continuation& k) {
+            if (_items.size() == _bound) {
+                _producers.push_back(producer_type(v, &k));
+                assert(valid());
+                return false;}
+            _items.push_back(v);
+            wake();
+            return true;}
+
+        /**
+         * @param b the first item to add
+         * @param e one past the last item to add
+         * @return one past the last item accepted
+         * accepts items from [b, e) until the queue is full, never suspending,
+         * and wakes every consumer it satisfies in one batch
+         */
+        template <typename II>
+        II push_back (II b, II e) {
+            while (b != e) {
+                if (!_consumers.empty()) {
+                    *_consumers.front().first = *b;
+                    _batch.push_back(_consumers.front().second);
+                    _consumers.pop_front();}
+                else if (_items.size() < _bound)
+                    _items.push_back(*b);
+                else
+                    break;
+                ++b;}
+            if (!_batch.empty())
+                _executor.post(_batch);
+            assert(valid());
+            return b;}
+
+        // -----
+        // bound
+        // -----
+
+        /**
+         * @return the most items held before push_back suspends
+         */
+        size_type bound () const {
+            return _bound;}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return true if no item is held
+         */
+        bool empty () const {
+            return _items.empty();}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of items held
+         */
+        size_type size () const {
+            return _items.size();}
+
+        // -------
+        // waiting
+        // -------
+
+        /**
+         * @return the number of parked consumers
+         */
+        size_type waiting_consumers () const {
+            return _consumers.size();}
+
+        /**
+         * @return the number of parked producers
+         */
+        size_type waiting_producers () const {
+            return _producers.size();}};
+
+#endif // AsyncDeque_h
@@ -0,0 +1,790 @@
+// -----------------------------
+// projects/deque/BenchDeque.c++
+// -----------------------------
+
+/*
+To run the benchmarks:
+    % g++ -ansi -pedantic -O2 -DNDEBUG -Wall BenchDeque.c++ -lpthread -o BenchDeque.c++.app
+    % BenchDeque.c++.app [n]
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // count, find, max, min
+#include <cstdio>     // fopen, fscanf, printf
+#include <cstdlib>    // atol
+#include <deque>      // deque
+#include <functional> // unary_function
+#include <iostream>   // cout, endl
+#include <iterator>   // distance
+#include <memory>     // allocator
+#include <vector>     // vector
+
+#include <pthread.h>  // pthread_cond_t, pthread_create, pthread_join, pthread_mutex_t
+#include <sys/time.h> // gettimeofday
+#include <unistd.h>   // sysconf
+
+#include "ArenaAllocator.h"
+#include "AsyncDeque.h"
+#include "CompressedDeque.h"
+#include "Deque.h"
+#include "DequePool.h"
+#include "KeyedDeque.h"
+#include "MemoryBudget.h"
+#include "MonotonicDeque.h"
+#include "SpillDeque.h"
+#include "StaticDeque.h"
+#include "TieredVector.h"
+#include "WindowAggregator.h"
+
+// ---
+// now
+// ---
+
+/**
+ * @return wall clock time in seconds
+ */
+double now () {
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + t.tv_usec / 1e6;}
+
+// ------
+// rss_kb
+// ------
+
+/**
+ * @return the resident set size of this process in kilobytes, or 0 if it can't be read
+ */
+long rss_kb () {
+    long   pages = 0;
+    long   rss   = 0;
+    FILE*  f     = std::fopen("/proc/self/statm", "r");
+    if (f == 0)
+        return 0;
+    if (std::fscanf(f, "%ld %ld", &pages, &rss) != 2)
+        rss = 0;
+    std::fclose(f);
+    return rss * (sysconf(_SC_PAGESIZE) / 1024);}
+
+// ------------
+// footprint_kb
+// ------------
+
+// The pool, spill, and flag benchmarks report what the containers say they
+// hold, not a change in RSS: the blocks they take often come from memory the
+// process already has resident, so an RSS delta reads 0 KB.
+
+/**
+ * @return the kilobytes held by x, by its own account
+ */
+template <typename C>
+long footprint_kb (const C& x) {
+    return x.memory_footprint() / 1024;}
+
+/**
+ * @return an estimate of the kilobytes held by x, from libstdc++'s layout:
+ * 512-byte blocks, one more than the elements fill, and a map two slots wider
+ */
+template <typename T>
+long footprint_kb (const std::deque<T>& x) {
+    const long per    = std::max(1L, long(512 / sizeof(T)));
+    const long blocks = long(x.size()) / per + 1;
+    return (sizeof(x) + blocks * per * sizeof(T) + (blocks + 2) * sizeof(T*)) / 1024;}
+
+/**
+ * @return the kilobytes held by a vector of deques and by each of them
+ */
+template <typename T>
+long footprint_kb (const std::vector< Deque<T> >& x) {
+    long n = x.capacity() * sizeof(Deque<T>);
+    for (std::size_t i = 0; i != x.size(); ++i)
+        n += x[i].memory_footprint() - sizeof(Deque<T>);
+    return n / 1024;}
+
+// ------
+// report
+// ------
+
+void report (const char* name, long n, double seconds, long kb) {
+    std::printf("%-32s n = %10ld  %10.3f ms  %10ld KB\n", name, n, seconds * 1e3, kb);}
+
+// ----------------
+// bench_compressed
+// ----------------
+
+/**
+ * @param x a deque of integers
+ * @param n the number of values to push
+ * fills x with a random walk of small steps, then reports the memory it took,
+ * the cost of random reads and the cost of a scan
+ */
+template <typename C>
+void bench_compressed (const char* name, long n) {
+    const long before = rss_kb();
+    C          x;
+    long       v = 0;
+    for (long i = 0; i != n; ++i) {
+        v += (i * 7919) % 17 - 8;
+        x.push_back(v);}
+    const long kb       = rss_kb() - before;
+    long       checksum = 0;
+    const long k        = 1000000;
+    double     t        = now();
+    for (long i = 0; i != k; ++i)
+        checksum += x[(i * 104729L) % n];
+    const double random = (now() - t) / k * 1e9;
+    const C& y = x;
+    t = now();
+    for (typename C::const_iterator b = y.begin(), e = y.end(); b != e; ++b)
+        checksum += *b;
+    const double scan = (now() - t) / n * 1e9;
+    std::printf("%-32s n = %10ld  %10ld KB  %8.1f ns/random read  %6.2f ns/scanned value\n", name, n, kb, random, scan);
+    if (checksum == 0)
+        std::printf("checksum %ld\n", checksum);}
+
+// ----------
+// bench_scan
+// ----------
+
+/**
+ * @param n the number of elements
+ * builds a Deque<int, A> alongside a second one, so their blocks interleave
+ * as they do when many deques grow at once, then reports the cost of a
+ * sequential scan by iterator and of strided reads by index
+ */
+template <typename A>
+void bench_scan (const char* name, long n) {
+    const long     before = rss_kb();
+    Deque<int, A>  x;
+    Deque<int, A>  y;
+    for (long i = 0; i != n; ++i) {
+        x.push_back(i);
+        y.push_back(i);}
+    const long           kb = rss_kb() - before;
+    const Deque<int, A>& c  = x;
+    long                 checksum = 0;
+    double               t        = now();
+    for (typename Deque<int, A>::const_iterator b = c.begin(), e = c.end(); b != e; ++b)
+        checksum += *b;
+    const double scan = (now() - t) / n * 1e9;
+    const long   k    = std::min(n, 10000000L);
+    t = now();
+    for (long i = 0; i != k; ++i)
+        checksum += c[(i * 4099L) % n];
+    const double stride = (now() - t) / k * 1e9;
+    std::printf("%-32s n = %10ld  %10ld KB  %6.2f ns/scanned value  %6.2f ns/strided read\n", name, n, kb, scan, stride);
+    if (checksum == 0)
+        std::printf("checksum %ld\n", checksum);}
+
+// -----------
+// bench_small
+// -----------
+
+/**
+ * @param s the most elements the deque holds
+ * reports the cost per element of building a deque of s elements, then
+ * draining it from the front, as a tight loop over small queues does
+ */
+template <typename C>
+void bench_small (const char* name, int s) {
+    const long k        = 100000000L / s;
+    long       checksum = 0;
+    const double t = now();
+    for (long i = 0; i != k; ++i) {
+        C x;
+        for (int j = 0; j != s; ++j)
+            x.push_back(j + i);
+        while (!x.empty()) {
+            checksum += x.front();
+            x.pop_front();}}
+    std::printf("%-32s s = %10d  %12.2f ns/element\n", name, s, (now() - t) / k / s * 1e9);
+    if (checksum == 0)
+        std::printf("checksum %ld\n", checksum);}
+
+// ------------
+// bench_insert
+// ------------
+
+/**
+ * @param n the number of elements
+ * reports the cost of inserting and then erasing at random positions in a sequence of n elements
+ */
+template <typename C>
+void bench_insert (const char* name, long n) {
+    C x;
+    for (long i = 0; i != n; ++i)
+        x.push_back(i);
+    const long   k = std::max(100L, 100000000L / n);
+    const double t = now();
+    for (long i = 0; i != k; ++i)
+        x.insert(x.begin() + (i * 7919L) % n, i);
+    for (long i = 0; i != k; ++i)
+        x.erase(x.begin() + (i * 104729L) % n);
+    std::printf("%-32s n = %10ld  %12.1f ns/insert or erase\n", name, n, (now() - t) / (2 * k) * 1e9);}
+
+// -----------
+// bench_flags
+// -----------
+
+/**
+ * @param x a sequence of flags
+ * @return the number that are set
+ */
+template <typename C>
+long count_flags (const C& x) {
+    return std::count(x.begin(), x.end(), true);}
+
+long count_flags (const Deque<bool>& x) {
+    return x.count();}
+
+/**
+ * @param x a sequence of flags
+ * @return the index of the first one that is unset
+ */
+template <typename C>
+long first_unset (const C& x) {
+    return std::distance(x.begin(), std::find(x.begin(), x.end(), false));}
+
+long first_unset (const Deque<bool>& x) {
+    return x.find_first_unset();}
+
+/**
+ * @param n the number of flags
+ * fills a sequence with n flags, all set but the last, then reports the memory
+ * it took, the cost of counting them and the cost of finding the unset one
+ */
+template <typename C>
+void bench_flags (const char* name, long n) {
+    C x;
+    for (long i = 0; i != n; ++i)
+        x.push_back(i != n - 1);
+    const long   kb    = footprint_kb(x);
+    double       t     = now();
+    const long   c     = count_flags(x);
+    const double count = (now() - t) / n * 1e9;
+    t = now();
+    const long   f     = first_unset(x);
+    const double find  = (now() - t) / n * 1e9;
+    if ((c != n - 1) || (f != n - 1))
+        std::printf("%s: wrong count or find\n", name);
+    std::printf("%-32s %8ld KB  %8.3f ns/flag counted  %8.3f ns/flag searched\n", name, kb, count, find);}
+
+// -----------
+// bench_spill
+// -----------
+
+/**
+ * a 64-byte POD message, as a buffering queue would hold
+ */
+struct Message {
+    long id;
+    char body[56];};
+
+/**
+ * @param x a queue of messages
+ * @param n the number of messages
+ * builds a backlog of n messages, as an outage would, then drains it, and
+ * reports the memory the backlog took and the cost of each push and pop
+ */
+template <typename C>
+void bench_spill (const char* name, C& x, long n) {
+    Message m = {0, "payload"};
+    double  t = now();
+    for (long i = 0; i != n; ++i) {
+        m.id = i;
+        x.push_back(m);}
+    const double push = (now() - t) / n * 1e9;
+    const long   kb   = footprint_kb(x);
+    t = now();
+    for (long i = 0; i != n; ++i) {
+        if (x.front().id != i)
+            std::printf("%s: out of order at %ld\n", name, i);
+        x.pop_front();}
+    const double pop = (now() - t) / n * 1e9;
+    std::printf("%-32s n = %10ld  %10ld KB  %8.1f ns/push  %8.1f ns/pop\n", name, n, kb, push, pop);}
+
+// ------------
+// bench_budget
+// ------------
+
+/**
+ * @param n the number of elements
+ * reports the cost of a push and pop through a budgeted Deque against a plain
+ * one, and the cost of a try_push_back that the budget refuses
+ */
+void bench_budget (long n) {
+    typedef Deque<int, BudgetAllocator<int> > B;
+    MemoryBudget b(n * sizeof(int) * 2);
+    B            x((BudgetAllocator<int>(b)));
+    Deque<int>   y;
+    double       t = now();
+    for (long i = 0; i != n; ++i)
+        x.push_back(i);
+    while (!x.empty())
+        x.pop_front();
+    const double budgeted = (now() - t) / n * 1e9;
+    t = now();
+    for (long i = 0; i != n; ++i)
+        y.push_back(i);
+    while (!y.empty())
+        y.pop_front();
+    const double plain = (now() - t) / n * 1e9;
+    while (x.try_push_back(0)) {}
+    const long k = 1000000;
+    long       refused = 0;
+    t = now();
+    for (long i = 0; i != k; ++i)
+        refused += !x.try_push_back(0);
+    const double fail = (now() - t) / k * 1e9;
+    std::printf("budget n = %10ld  %6.1f ns/push and pop budgeted  %6.1f ns/push and pop plain  %6.1f ns/refused try_push_back\n", n, budgeted, plain, fail);
+    if (refused != k)
+        std::printf("budget: %ld of %ld pushes refused\n", refused, k);}
+
+// -------------
+// bench_startup
+// -------------
+
+/**
+ * @param n the number of elements
+ * reports the cost and the memory of constructing a sequence of n zeros,
+ * and of then writing every hundredth page of it
+ */
+template <typename C>
+void bench_startup (const char* name, long n) {
+    const long   before = rss_kb();
+    double       t      = now();
+    C            x(n, 0);
+    const double built  = now() - t;
+    const long   kb     = rss_kb() - before;
+    t = now();
+    for (long i = 0; i < n; i += 100 * 4096 / sizeof(unsigned))
+        x[i] = 1;
+    const double touched = now() - t;
+    std::printf("%-32s n = %10ld  %10.3f ms  %10ld KB  %10.3f ms to write every 100th page\n", name, n, built * 1e3, kb, touched * 1e3);}
+
+// ----------
+// bench_pool
+// ----------
+
+/**
+ * @param c the number of connections
+ * @param k the number of frames queued on each
+ * gives each of c connections a queue of frames, from a DequePool and then as
+ * independent Deques, and reports the memory of the idle queues, the memory
+ * with k frames queued, and the cost of each enqueue and dequeue
+ */
+void bench_pool (long c, int k) {
+    typedef DequePool<void*> P;
+    double t;
+    {
+    P                p;
+    P::handle* const x    = new P::handle[c];
+    const long       idle = (p.memory_footprint() + c * sizeof(P::handle)) / 1024;
+    t = now();
+    for (int j = 0; j != k; ++j)
+        for (long i = 0; i != c; ++i)
+            p.push_back(x[i], &x[i]);
+    const double enqueue = (now() - t) / (c * k) * 1e9;
+    const long   busy    = (p.memory_footprint() + c * sizeof(P::handle)) / 1024;
+    t = now();
+    for (int j = 0; j != k; ++j)
+        for (long i = 0; i != c; ++i)
+            p.pop_front(x[i]);
+    const double dequeue = (now() - t) / (c * k) * 1e9;
+    std::printf("pool,  DequePool     c = %8ld  k = %d  %8ld KB idle  %8ld KB busy  %6.1f ns/enqueue  %6.1f ns/dequeue\n", c, k, idle, busy, enqueue, dequeue);
+    delete [] x;
+    }
+    {
+    std::vector< Deque<void*> > x(c);
+    const long                  idle = footprint_kb(x);
+    t = now();
+    for (int j = 0; j != k; ++j)
+        for (long i = 0; i != c; ++i)
+            x[i].push_back(&x[i]);
+    const double enqueue = (now() - t) / (c * k) * 1e9;
+    const long   busy    = footprint_kb(x);
+    t = now();
+    for (int j = 0; j != k; ++j)
+        for (long i = 0; i != c; ++i)
+            x[i].pop_front();
+    const double dequeue = (now() - t) / (c * k) * 1e9;
+    std::printf("pool,  Deque         c = %8ld  k = %d  %8ld KB idle  %8ld KB busy  %6.1f ns/enqueue  %6.1f ns/dequeue\n", c, k, idle, busy, enqueue, dequeue);
+    }}
+
+// -----------
+// bench_keyed
+// -----------
+
+/**
+ * an event and its timestamp, as a time-series window would hold
+ */
+struct Event {
+    long time;
+    long value;};
+
+struct time_of : std::unary_function<Event, long> {
+    long operator () (const Event& e) const {
+        return e.time;}};
+
+/**
+ * @return the index of the first event in x at or after time t
+ */
+long deque_lower_bound (const Deque<Event>& x, long t) {
+    long lo = 0;
+    long hi = x.size();
+    while (lo != hi) {
+        const long mid = lo + (hi - lo) / 2;
+        if (x[mid].time < t)
+            lo = mid + 1;
+        else
+            hi = mid;}
+    return lo;}
+
+/**
+ * @param n the number of events, two per tick
+ * @param q the number of range queries
+ * fills a window of n events, in a KeyedDeque and then in a Deque searched by
+ * index, counts the events in q ranges of n / 200 ticks, then evicts the
+ * window 1% at a time, and reports the cost of each push, query, and eviction
+ */
+void bench_keyed (long n, long q) {
+    const long w = n / 200;
+    double     t;
+    {
+    KeyedDeque<Event, time_of> x;
+    t = now();
+    for (long i = 0; i != n; ++i) {
+        const Event e = {i / 2, i};
+        x.push_back(e);}
+    const double push = (now() - t) / n * 1e9;
+    long         c    = 0;
+    unsigned     r    = 1;
+    t = now();
+    for (long j = 0; j != q; ++j) {
+        r = r * 1103515245 + 12345;
+        const long a = r % (n / 2);
+        c += x.upper_bound(a + w - 1) - x.lower_bound(a);}
+    const double query = (now() - t) / q * 1e9;
+    t = now();
+    for (long a = w; !x.empty(); a += w)
+        x.evict_before(a);
+    const double evict = (now() - t) / 100 * 1e9;
+    std::printf("keyed, KeyedDeque<Event>  n = %10ld  %6.1f ns/push  %8.1f ns/query  %10.0f ns/evict  %ld\n", n, push, query, evict, c);
+    }
+    {
+    Deque<Event> x;
+    t = now();
+    for (long i = 0; i != n; ++i) {
+        const Event e = {i / 2, i};
+        x.push_back(e);}
+    const double push = (now() - t) / n * 1e9;
+    long         c    = 0;
+    unsigned     r    = 1;
+    t = now();
+    for (long j = 0; j != q; ++j) {
+        r = r * 1103515245 + 12345;
+        const long a = r % (n / 2);
+        c += deque_lower_bound(x, a + w) - deque_lower_bound(x, a);}
+    const double query = (now() - t) / q * 1e9;
+    t = now();
+    for (long a = w; !x.empty(); a += w)
+        while (!x.empty() && (x.front().time < a))
+            x.pop_front();
+    const double evict = (now() - t) / 100 * 1e9;
+    std::printf("keyed, Deque<Event>       n = %10ld  %6.1f ns/push  %8.1f ns/query  %10.0f ns/evict  %ld\n", n, push, query, evict, c);
+    }}
+
+// --------------
+// bench_snapshot
+// --------------
+
+/**
+ * @param n     the number of elements in the live deque
+ * @param cow   whether the live deque is copy-on-write
+ * @param k     the number of snapshots taken
+ * takes k snapshots of a deque, writing a few elements between them,
+ * and reports the average snapshot latency and the memory the snapshots hold
+ */
+void bench_snapshot (long n, bool cow, int k) {
+    Deque<int> x;
+    x.set_copy_on_write(cow);
+    for (long i = 0; i != n; ++i)
+        x.push_back(i);
+    std::vector< Deque<int>* > snapshots;
+    const long   before  = rss_kb();
+    double       elapsed = 0;
+    for (int i = 0; i != k; ++i) {
+        const double t = now();
+        snapshots.push_back(new Deque<int>(x));
+        elapsed += now() - t;
+        for (int j = 0; j != 100; ++j)
+            x[(j * 7919L + i) % n] = i;}
+    report(cow ? "snapshot, copy-on-write" : "snapshot, deep copy", n, elapsed / k, rss_kb() - before);
+    for (int i = 0; i != k; ++i)
+        delete snapshots[i];}
+
+// ------------
+// bench_window
+// ------------
+
+/**
+ * @param w the window size
+ * reports the cost per event of a rolling min and sum by rescanning the
+ * window, by MonotonicDeque and by WindowAggregator; the rescan is timed
+ * over fewer events, the others over at least 2w so their cost is amortized
+ */
+void bench_window (long w) {
+    double checksum = 0;
+    {
+    const long k = std::max(100L, 100000000L / w);
+    Deque<double> x;
+    for (long i = 0; i != w; ++i)
+        x.push_back(i % 1009);
+    const double t = now();
+    for (long i = 0; i != k; ++i) {
+        x.pop_front();
+        x.push_back((i * 7919) % 1009);
+        double lo  = x[0];
+        double sum = 0;
+        for (long j = 0; j != w; ++j) {
+            lo   = std::min(lo, x[j]);
+            sum += x[j];}
+        checksum += lo + sum;}
+    std::printf("%-32s w = %10ld  %12.1f ns/event\n", "window, rescan min and sum", w, (now() - t) / k * 1e9);
+    }
+    {
+    MonotonicDeque<double>                 lo;
+    WindowAggregator< double, Sum<double> > sum;
+    for (long i = 0; i != w; ++i) {
+        lo.push_back(i % 1009);
+        sum.push_back(i % 1009);}
+    const long   k = std::max(1000000L, 2 * w);
+    const double t = now();
+    for (long i = 0; i != k; ++i) {
+        lo.pop_front();
+        sum.pop_front();
+        lo.push_back((i * 7919) % 1009);
+        sum.push_back((i * 7919) % 1009);
+        checksum += lo.front() + sum.query();}
+    std::printf("%-32s w = %10ld  %12.1f ns/event\n", "window, MonotonicDeque + Sum", w, (now() - t) / k * 1e9);
+    }
+    {
+    WindowAggregator< double, Min<double> > lo;
+    for (long i = 0; i != w; ++i)
+        lo.push_back(i % 1009);
+    const long   k = std::max(1000000L, 2 * w);
+    const double t = now();
+    for (long i = 0; i != k; ++i) {
+        lo.pop_front();
+        lo.push_back((i * 7919) % 1009);
+        checksum += lo.query();}
+    std::printf("%-32s w = %10ld  %12.1f ns/event\n", "window, WindowAggregator Min", w, (now() - t) / k * 1e9);
+    }
+    if (checksum == 0)
+        std::printf("checksum %f\n", checksum);}
+
+// -------------
+// bench_handoff
+// -------------
+
+/**
+ * one producer and one consumer handing off items through a Deque guarded by a mutex and two condition variables
+ */
+struct LockedPipe {
+    pthread_mutex_t mutex;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    Deque<long>     items;
+    long            bound;
+    long            n;
+    long            sum;
+
+    LockedPipe (long b, long n) : bound(b), n(n), sum(0) {
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&not_empty, 0);
+        pthread_cond_init(&not_full,  0);}
+
+    ~LockedPipe () {
+        pthread_cond_destroy(&not_full);
+        pthread_cond_destroy(&not_empty);
+        pthread_mutex_destroy(&mutex);}};
+
+void* locked_producer (void* p) {
+    LockedPipe& x = *static_cast<LockedPipe*>(p);
+    for (long i = 0; i != x.n; ++i) {
+        pthread_mutex_lock(&x.mutex);
+        while (long(x.items.size()) == x.bound)
+            pthread_cond_wait(&x.not_full, &x.mutex);
+        x.items.push_back(i);
+        pthread_cond_signal(&x.not_empty);
+        pthread_mutex_unlock(&x.mutex);}
+    return 0;}
+
+void* locked_consumer (void* p) {
+    LockedPipe& x = *static_cast<LockedPipe*>(p);
+    for (long i = 0; i != x.n; ++i) {
+        pthread_mutex_lock(&x.mutex);
+        while (x.items.empty())
+            pthread_cond_wait(&x.not_empty, &x.mutex);
+        x.sum += x.items.front();
+        x.items.pop_front();
+        pthread_cond_signal(&x.not_full);
+        pthread_mutex_unlock(&x.mutex);}
+    return 0;}
+
+/**
+ * one producer stage and one consumer stage handing off items through an
+ * AsyncDeque, both resumed by one executor on one thread; an AsyncDeque is
+ * not shared between threads, so this measures a same-thread handoff against
+ * the cross-thread one of LockedPipe, not two AsyncDeque threads
+ */
+struct AsyncPipe {
+    struct Producer : Continuation {
+        AsyncDeque<long>& q;
+        long              i;
+        long              n;
+
+        Producer (AsyncDeque<long>& q, long n) : q(q), i(0), n(n) {}
+
+        void resume () {
+            while (i != n)
+                if (!q.push_back(i++, *this))
+                    return;}};
+
+    struct Consumer : Continuation {
+        AsyncDeque<long>& q;
+        long              slot;
+        long              sum;
+        bool              parked;
+
+        explicit Consumer (AsyncDeque<long>& q) : q(q), slot(0), sum(0), parked(false) {}
+
+        void resume () {
+            if (parked)
+                sum += slot;
+            while (q.pop_front(slot, *this))
+                sum += slot;
+            parked = true;}};
+
+    long bound;
+    long n;
+    long sum;
+
+    AsyncPipe (long b, long n) : bound(b), n(n), sum(0) {}};
+
+void* async_pipe (void* p) {
+    AsyncPipe&          x = *static_cast<AsyncPipe*>(p);
+    Executor            e;
+    AsyncDeque<long>    q(e, x.bound);
+    AsyncPipe::Consumer c(q);
+    AsyncPipe::Producer d(q, x.n);
+    e.post(c);
+    e.post(d);
+    e.run();
+    x.sum = c.sum;
+    return 0;}
+
+/**
+ * @param n the number of items each pipeline hands off
+ * @param k the number of pipelines
+ * reports the handoff throughput of k pipelines, first with a thread per
+ * stage blocking on condition variables, then with a thread per pipeline
+ * running both stages on an executor
+ */
+void bench_handoff (long n, int k) {
+    const long bound = 64;
+    const long sum   = n * (n - 1) / 2;
+    {
+    std::vector<LockedPipe*> x;
+    std::vector<pthread_t>   t(2 * k);
+    for (int i = 0; i != k; ++i)
+        x.push_back(new LockedPipe(bound, n));
+    const double s = now();
+    for (int i = 0; i != k; ++i) {
+        pthread_create(&t[2 * i],     0, locked_producer, x[i]);
+        pthread_create(&t[2 * i + 1], 0, locked_consumer, x[i]);}
+    for (int i = 0; i != 2 * k; ++i)
+        pthread_join(t[i], 0);
+    const double seconds = now() - s;
+    for (int i = 0; i != k; ++i) {
+        if (x[i]->sum != sum)
+            std::printf("handoff, mutex + condvar: wrong sum\n");
+        delete x[i];}
+    std::printf("%-32s k = %10d  %12.1f M items/s\n", "handoff, mutex + condvar", k, n * k / seconds / 1e6);
+    }
+    {
+    std::vector<AsyncPipe> x(k, AsyncPipe(bound, n));
+    std::vector<pthread_t> t(k);
+    const double s = now();
+    for (int i = 0; i != k; ++i)
+        pthread_create(&t[i], 0, async_pipe, &x[i]);
+    for (int i = 0; i != k; ++i)
+        pthread_join(t[i], 0);
+    const double seconds = now() - s;
+    for (int i = 0; i != k; ++i)
+        if (x[i].sum != sum)
+            std::printf("handoff, AsyncDeque + Executor: wrong sum\n");
+    std::printf("%-32s k = %10d  %12.1f M items/s\n", "handoff, AsyncDeque + Executor", k, n * k / seconds / 1e6);
+    }}
+
+// ----
+// main
+// ----
+
+int main (int argc, char* argv[]) {
+    using namespace std;
+    cout << "BenchDeque.c++" << endl;
+
+    const long n = (argc > 1) ? atol(argv[1]) : 10000000;
+
+    bench_scan< ArenaAllocator<int> >("scan, ArenaAllocator", n);
+    bench_scan< std::allocator<int> >("scan, std::allocator", n);
+
+    bench_compressed< CompressedDeque<long> >("history, CompressedDeque<long>", n);
+    bench_compressed<           Deque<long> >("history, Deque<long>",           n);
+
+    bench_snapshot(n, true,  10);
+    bench_snapshot(n, false, 10);
+
+    for (long w = 1000; w <= 1000000; w *= 10)
+        bench_window(w);
+
+    for (int k = 1; k <= 4; k *= 2)
+        bench_handoff(1000000, k);
+
+    for (int s = 4; s <= 64; s *= 4) {
+        bench_small< StaticDeque<int, 64> >("small, StaticDeque<int, 64>", s);
+        bench_small<       Deque<int>     >("small, Deque<int>",           s);
+        bench_small<  std::deque<int>     >("small, std::deque<int>",      s);}
+
+    for (long m = 10000; m <= 1000000; m *= 10) {
+        bench_insert< TieredVector<int> >("insert, TieredVector<int>", m);
+        bench_insert<        Deque<int> >("insert, Deque<int>",        m);
+        bench_insert<   std::deque<int> >("insert, std::deque<int>",   m);}
+
+    bench_flags< Deque<bool>      >("flags, Deque<bool>",      n);
+    bench_flags< Deque<char>      >("flags, Deque<char>",      n);
+    bench_flags< std::deque<bool> >("flags, std::deque<bool>", n);
+
+    SpillDeque<Message> s(16);
+    Deque<Message>      d;
+    bench_spill("spill, SpillDeque<Message>", s, n);
+    bench_spill("spill, Deque<Message>",      d, n);
+
+    bench_budget(n);
+
+    bench_startup< Deque<unsigned, ArenaAllocator<unsigned> > >("startup, Deque, ArenaAllocator", n);
+    bench_startup< Deque<unsigned>                            >("startup, Deque<unsigned>",        n);
+    bench_startup< std::deque<unsigned>                       >("startup, std::deque<unsigned>",   n);
+    bench_startup< std::vector<unsigned>                      >("startup, std::vector<unsigned>",  n);
+
+    for (int k = 1; k <= 16; k *= 4)
+        bench_pool(2000000, k);
+
+    bench_keyed(n, 1000000);
+
+    cout << "Done." << endl;
+    return 0;}
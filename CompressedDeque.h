@@ -0,0 +1,535 @@
+// --------------------------------
+// projects/deque/CompressedDeque.h
+// --------------------------------
+
+#ifndef CompressedDeque_h
+#define CompressedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>   // assert
+#include <iterator>  // input_iterator_tag
+#include <limits>    // numeric_limits
+#include <memory>    // allocator
+#include <stdexcept> // invalid_argument
+#include <vector>    // vector
+
+#include "Deque.h"
+
+// ---------------
+// CompressedDeque
+// ---------------
+
+/**
+ * A deque of integers that keeps its interior compressed.
+ * The values are held in three parts: a hot head and a hot tail, which are
+ * plain Deques, and between them a Deque of cold blocks of BLOCK_SIZE values.
+ * A cold block stores its first value and the zigzag-encoded deltas between
+ * neighbors, bit-packed at the width of the largest one, so histories that
+ * move in small steps shrink by roughly 64 / width.
+ * push and pop only touch the hot ends: a hot end is packed into a cold block
+ * when it reaches 2 * BLOCK_SIZE values and a cold block is unpacked when a hot
+ * end runs dry, so both are amortized O(1).
+ * A random read of a cold value decodes its block up to that value, so it costs
+ * at most BLOCK_SIZE steps; an iterator keeps its own place in the block it is
+ * in, so a scan decodes each value once.
+ * Reads return values, not references; cold values can't be written in place.
+ * Reads write nothing in the deque, so any number of threads may read it at
+ * once, as long as none writes it meanwhile.
+ */
+template < typename T, typename A = std::allocator<T> >
+class CompressedDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+        typedef typename allocator_type::const_reference const_reference;
+
+        typedef unsigned long word_type;
+
+        typedef typename allocator_type::template rebind<word_type>::other word_allocator_type;
+
+        /**
+         * a packed run of BLOCK_SIZE values
+         */
+        struct block_type {
+            value_type                                  base;
+            unsigned                                    width;
+            std::vector<word_type, word_allocator_type> words;
+
+            explicit block_type (const word_allocator_type& a) :
+                    base(),
+                    width(0),
+                    words(a) {}};
+
+        typedef typename allocator_type::template rebind<block_type>::other block_allocator_type;
+
+        enum {
+            BLOCK_SIZE = 256,
+            WORD_BITS  = std::numeric_limits<word_type>::digits};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::input_iterator_tag                   iterator_category;
+                typedef typename CompressedDeque::value_type      value_type;
+                typedef typename CompressedDeque::difference_type difference_type;
+                typedef const value_type*                         pointer;
+                typedef value_type                                reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return (lhs._index == rhs._index) && (lhs._deque == rhs._deque);}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type              _index;
+                const CompressedDeque* _deque;
+
+                /**
+                 * the position whose cold value the decoder state below holds, or size_type(-1);
+                 * the state is the iterator's own, so readers share nothing they write
+                 */
+                mutable size_type        _at;
+                mutable unsigned         _width;
+                mutable const word_type* _word;
+                mutable unsigned         _offset;
+                mutable word_type        _value;
+
+                // ----
+                // cold
+                // ----
+
+                /**
+                 * @return the position of _index among the cold values, or size_type(-1) if it is hot
+                 */
+                size_type cold () const {
+                    const size_type h = _deque->_head.size();
+                    if ((_index < h) || (_index - h >= _deque->_cold.size() * BLOCK_SIZE))
+                        return size_type(-1);
+                    return _index - h;}
+
+                // ----
+                // seek
+                // ----
+
+                /**
+                 * @param i the position of _index among the cold values
+                 * decodes the block holding i up to it, in at most BLOCK_SIZE steps
+                 */
+                void seek (size_type i) const {
+                    const block_type& b = _deque->_cold[i / BLOCK_SIZE];
+                    _width  = b.width;
+                    _word   = b.width ? &b.words[0] : 0;
+                    _offset = 0;
+                    _value  = word_type(b.base);
+                    for (size_type k = i % BLOCK_SIZE; k != 0; --k)
+                        step(_width, _word, _offset, _value);
+                    _at = _index;}
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                const_iterator (size_type index, const CompressedDeque* deque) :
+                        _index(index),
+                        _deque(deque),
+                        _at(size_type(-1)),
+                        _width(0),
+                        _word(0),
+                        _offset(0),
+                        _value(0) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return the value at this position; a cold one is decoded from the place
+                 * the last ++ left, in O(1), or else from the start of its block
+                 */
+                reference operator * () const {
+                    const size_type i = cold();
+                    if (i == size_type(-1))
+                        return (*_deque)[_index];
+                    if (_at != _index)
+                        seek(i);
+                    return value_type(_value);}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * steps the decoder along with the position while it stays in one block
+                 */
+                const_iterator& operator ++ () {
+                    if ((_at == _index) && ((cold() + 1) % BLOCK_SIZE != 0)) {
+                        step(_width, _word, _offset, _value);
+                        ++_at;}
+                    ++_index;
+                    return *this;}
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                const_iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                const_iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                const_iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Deque<value_type, allocator_type> _head;
+
+        Deque<block_type, block_allocator_type> _cold;
+
+        Deque<value_type, allocator_type> _tail;
+
+        word_allocator_type _words;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return std::numeric_limits<value_type>::is_integer
+                && (sizeof(value_type) <= sizeof(word_type))
+                && (_head.size() < 2 * size_type(BLOCK_SIZE))
+                && (_tail.size() < 2 * size_type(BLOCK_SIZE));}
+
+        // ------
+        // zigzag
+        // ------
+
+        static word_type zigzag (word_type d) {
+            return (d << 1) ^ (word_type(0) - (d >> (WORD_BITS - 1)));}
+
+        static word_type unzigzag (word_type z) {
+            return (z >> 1) ^ (word_type(0) - (z & 1));}
+
+        // ----
+        // pack
+        // ----
+
+        /**
+         * @param x a Deque holding the values to pack
+         * @param i the index in x of the first of BLOCK_SIZE values
+         * @param b the block to fill
+         */
+        static void pack (const Deque<value_type, allocator_type>& x, size_type i, block_type& b) {
+            word_type z[BLOCK_SIZE];
+            word_type m = 0;
+            for (size_type k = 1; k != size_type(BLOCK_SIZE); ++k) {
+                z[k] = zigzag(word_type(x[i + k]) - word_type(x[i + k - 1]));
+                m   |= z[k];}
+            b.base  = x[i];
+            b.width = 0;
+            while ((b.width != unsigned(WORD_BITS)) && ((m >> b.width) != 0))
+                ++b.width;
+            b.words.assign(((BLOCK_SIZE - 1) * b.width + WORD_BITS - 1) / WORD_BITS, 0);
+            if (b.width == 0)
+                return;
+            for (size_type k = 1; k != size_type(BLOCK_SIZE); ++k) {
+                const size_type p = (k - 1) * b.width;
+                const size_type o = p % WORD_BITS;
+                b.words[p / WORD_BITS] |= z[k] << o;
+                if (o + b.width > size_type(WORD_BITS))
+                    b.words[p / WORD_BITS + 1] |= z[k] >> (WORD_BITS - o);}}
+
+        // ----
+        // step
+        // ----
+
+        /**
+         * @param w the width of a block's deltas
+         * @param p the word holding the next delta
+         * @param o the bit at which it starts in *p
+         * @param v the value before it, which becomes the value after it
+         * decodes one delta, moving p and o past it
+         */
+        static void step (unsigned w, const word_type*& p, unsigned& o, word_type& v) {
+            if (w == 0)
+                return;
+            const word_type mask = (w == unsigned(WORD_BITS)) ? ~word_type(0) : (word_type(1) << w) - 1;
+            word_type       z    = *p >> o;
+            o += w;
+            if (o >= unsigned(WORD_BITS)) {
+                o -= WORD_BITS;
+                ++p;
+                if (o != 0)
+                    z |= *p << (w - o);}
+            v += unzigzag(z & mask);}
+
+        // ------
+        // unpack
+        // ------
+
+        /**
+         * @param b the block to decode
+         * @param x where its BLOCK_SIZE values are written
+         */
+        static void unpack (const block_type& b, value_type* x) {
+            const word_type* p = b.width ? &b.words[0] : 0;
+            unsigned         o = 0;
+            word_type        v = word_type(b.base);
+            x[0] = b.base;
+            for (size_type k = 1; k != size_type(BLOCK_SIZE); ++k) {
+                step(b.width, p, o, v);
+                x[k] = value_type(v);}}
+
+        // ------
+        // decode
+        // ------
+
+        /**
+         * @param b a block
+         * @param k the position of a value in it
+         * @return the value, decoded from the start of b in k steps
+         */
+        static value_type decode (const block_type& b, size_type k) {
+            const word_type* p = b.width ? &b.words[0] : 0;
+            unsigned         o = 0;
+            word_type        v = word_type(b.base);
+            for (; k != 0; --k)
+                step(b.width, p, o, v);
+            return value_type(v);}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        explicit CompressedDeque (const allocator_type& a = allocator_type()) :
+                _head(a),
+                _cold(block_allocator_type(a)),
+                _tail(a),
+                _words(a) {
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index the position of a value
+         * @return the value, decoding its block up to it if it is cold
+         */
+        value_type operator [] (size_type index) const {
+            if (index < _head.size())
+                return _head[index];
+            index -= _head.size();
+            const size_type n = _cold.size() * BLOCK_SIZE;
+            if (index < n)
+                return decode(_cold[index / BLOCK_SIZE], index % BLOCK_SIZE);
+            return _tail[index - n];}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        value_type at (size_type index) const {
+            if (index >= size())
+                throw std::invalid_argument("CompressedDeque::at index out of range");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        value_type back () const {
+            assert(!empty());
+            return (*this)[size() - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        const_iterator begin () const {
+            return const_iterator(0, this);}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return size() == 0;}
+
+        // ---
+        // end
+        // ---
+
+        const_iterator end () const {
+            return const_iterator(size(), this);}
+
+        // -----
+        // front
+        // -----
+
+        value_type front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // --------
+        // pop_back
+        // --------
+
+        /**
+         * unpacks the last cold block into the tail if the tail is empty
+         */
+        void pop_back () {
+            assert(!empty());
+            if (_tail.empty()) {
+                if (_cold.empty()) {
+                    _head.pop_back();
+                    return;}
+                value_type x[BLOCK_SIZE];
+                unpack(_cold.back(), x);
+                for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k)
+                    _tail.push_back(x[k]);
+                _cold.pop_back();}
+            _tail.pop_back();
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * unpacks the first cold block into the head if the head is empty
+         */
+        void pop_front () {
+            assert(!empty());
+            if (_head.empty()) {
+                if (_cold.empty()) {
+                    _tail.pop_front();
+                    return;}
+                value_type x[BLOCK_SIZE];
+                unpack(_cold.front(), x);
+                for (size_type k = BLOCK_SIZE; k != 0; --k)
+                    _head.push_front(x[k - 1]);
+                _cold.pop_front();}
+            _head.pop_front();
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * packs the oldest BLOCK_SIZE values of the tail once it holds 2 * BLOCK_SIZE
+         */
+        void push_back (const_reference v) {
+            _tail.push_back(v);
+            if (_tail.size() == 2 * size_type(BLOCK_SIZE)) {
+                _cold.push_back(block_type(_words));
+                try {
+                    pack(_tail, 0, _cold.back());}
+                catch (...) {
+                    _cold.pop_back();
+                    throw;}
+                for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k)
+                    _tail.pop_front();}
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        /**
+         * packs the newest BLOCK_SIZE values of the head once it holds 2 * BLOCK_SIZE
+         */
+        void push_front (const_reference v) {
+            _head.push_front(v);
+            if (_head.size() == 2 * size_type(BLOCK_SIZE)) {
+                _cold.push_front(block_type(_words));
+                try {
+                    pack(_head, BLOCK_SIZE, _cold.front());}
+                catch (...) {
+                    _cold.pop_front();
+                    throw;}
+                for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k)
+                    _head.pop_back();}
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _head.size() + _cold.size() * BLOCK_SIZE + _tail.size();}
+
+        // ------------
+        // packed_bytes
+        // ------------
+
+        /**
+         * @return the bytes held by the packed words of the cold blocks
+         */
+        size_type packed_bytes () const {
+            size_type n = 0;
+            for (size_type i = 0; i != _cold.size(); ++i)
+                n += _cold[i].words.size() * sizeof(word_type);
+            return n;}};
+
+#endif // CompressedDeque_h
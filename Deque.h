@@ -15,8 +15,11 @@
 
 #include <algorithm> // equal, lexicographical_compare
 #include <cassert>   // assert
+#include <cstddef>   // size_t
 #include <iterator>  // iterator, bidirectional_iterator_tag
+#include <limits>    // numeric_limits
 #include <memory>    // allocator
+#include <new>       // bad_alloc
 #include <stdexcept> // out_of_range
 #include <utility>   // !=, <=, >, >=
 
@@ -73,10 +76,137 @@ BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
         throw;}
     return e;}
 
+// --------
+// prefetch
+// --------
+
+/**
+ * hints that the memory at p will be read soon; Deque calls it with a pointer to
+ * its element type, so an overload for that type can count the prefetches
+ */
+inline void prefetch (const void* p) {
+#ifdef __GNUC__
+    __builtin_prefetch(p);
+#else
+    (void) p;
+#endif
+    }
+
+// ------------
+// can_allocate
+// ------------
+
+/**
+ * @return false if a is known to refuse an allocation of bytes; an allocator that
+ * can tell overloads this, so that Deque's try_push fails without throwing
+ */
+template <typename A>
+bool can_allocate (const A&, std::size_t) {
+    return true;}
+
+// ---------------
+// allocate_zeroed
+// ---------------
+
+/**
+ * @param zeroed set to true if the space is known to be all zero bits
+ * @return uninitialized space for n elements from a; an allocator that hands out
+ * untouched zero pages overloads this, so that Deque can skip filling them with zeros
+ */
+template <typename A>
+typename A::pointer allocate_zeroed (A& a, typename A::size_type n, bool& zeroed) {
+    zeroed = false;
+    return a.allocate(n);}
+
+// ---------
+// zero_bits
+// ---------
+
+/**
+ * @return true if v is arithmetic and all zero bits, so that zeroed space already holds it
+ */
+template <typename T>
+bool zero_bits (const T& v) {
+    if (!std::numeric_limits<T>::is_specialized)
+        return false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+    for (std::size_t i = 0; i != sizeof(T); ++i)
+        if (p[i] != 0)
+            return false;
+    return true;}
+
+// ----------------
+// ClassicAllocator
+// ----------------
+
+#if __cplusplus > 201703L
+/**
+ * std::allocator with the members C++20 removed from it put back, so that the
+ * containers, which use the C++98 allocator interface, also build as C++20
+ */
+template <typename T>
+class ClassicAllocator : public std::allocator<T> {
+    public:
+        typedef T*       pointer;
+        typedef const T* const_pointer;
+        typedef T&       reference;
+        typedef const T& const_reference;
+
+        template <typename U>
+        struct rebind {
+            typedef ClassicAllocator<U> other;};
+
+        ClassicAllocator () {}
+
+        template <typename U>
+        ClassicAllocator (const ClassicAllocator<U>&) {}
+
+        template <typename U>
+        ClassicAllocator (const std::allocator<U>&) {}
+
+        void construct (pointer p, const_reference v) {
+            new (p) T(v);}
+
+        void destroy (pointer p) {
+            p->~T();}};
+#endif
+
+// -----------------
+// classic_allocator
+// -----------------
+
+/**
+ * classic_allocator<A>::type is the allocator a container given A works with:
+ * A itself, except that under C++20 std::allocator<T> becomes ClassicAllocator<T>
+ */
+template <typename A>
+struct classic_allocator {
+    typedef A type;};
+
+#if __cplusplus > 201703L
+template <typename T>
+struct classic_allocator< std::allocator<T> > {
+    typedef ClassicAllocator<T> type;};
+#endif
+
 // -----
 // Deque
 // -----
 
+/**
+ * A double-ended queue held in fixed-size inner arrays, reached through an outer
+ * array of pointers to them, so indexing is O(1) and pushing at either end never
+ * moves an element.
+ * In copy-on-write mode (see set_copy_on_write) copies share inner arrays, and
+ * anything that hands out a way to write an element copies that element's inner
+ * array first if it is shared: non-const operator [], at, front, back, and
+ * dereferencing a non-const iterator, even when the result is only read. Read
+ * through a const Deque& to keep sharing. A reference or pointer obtained before
+ * a copy still points into the inner array the copy shares, so writing through it
+ * after the copy changes the copy too: copying a copy-on-write deque invalidates,
+ * for writing, every reference and pointer into it; obtain them again after the
+ * copy. An iterator holds a position, not an address, so it stays usable.
+ */
 template < typename T, typename A = std::allocator<T> >
 class Deque {
     public:
@@ -84,7 +214,7 @@ class Deque {
         // typedefs
         // --------
 
-        typedef A                                        allocator_type;
+        typedef typename classic_allocator<A>::type      allocator_type;
         typedef typename allocator_type::value_type      value_type;
 
         typedef typename allocator_type::size_type       size_type;
@@ -101,6 +231,12 @@ class Deque {
         typedef typename pointer_allocator_type::pointer        pointer_pointer;
         typedef typename pointer_allocator_type::const_pointer  pointer_const_pointer;
 
+        typedef typename allocator_type::template rebind<size_type>::other     count_allocator_type;
+        typedef typename count_allocator_type::pointer                         count_pointer;
+
+        typedef typename allocator_type::template rebind<count_pointer>::other count_pointer_allocator_type;
+        typedef typename count_pointer_allocator_type::pointer                 count_pointer_pointer;
+
     public:
         // -----------
         // operator ==
@@ -144,6 +280,16 @@ class Deque {
                         
         pointer _front, _back;
 
+        // Copy-on-write: when _cow is set, _refs parallels the outer array and holds, for each
+        // inner array, a pointer to its reference count, which is changed only atomically
+        count_allocator_type _ref_alloc;
+
+        count_pointer_allocator_type _refs_alloc;
+
+        count_pointer_pointer _refs;
+
+        bool _cow;
+
     private:
         // -----
         // valid
@@ -151,7 +297,522 @@ class Deque {
 
         bool valid () const {
             return (_outer_pfront == 0 && _outer_lfront == 0 && _outer_lback == 0 && _outer_pback == 0 && _front == 0 && _back == 0)
-                || (_outer_pfront <= _outer_lfront && _outer_lfront <= _outer_lback && _outer_lback <= _outer_pback && *_outer_lfront <= _front && _back <= *(_outer_lback-1) + INNER_SIZE);}
+                || (_outer_pfront <= _outer_lfront && _outer_lfront < _outer_lback && _outer_lback <= _outer_pback
+                    && *_outer_lfront <= _front && _front < *_outer_lfront + INNER_SIZE
+                    && *(_outer_lback-1) <= _back && _back < *(_outer_lback-1) + INNER_SIZE);}
+
+        // ----------
+        // init_outer
+        // ----------
+
+        /**
+         * @param s the number of elements the blocks must hold
+         * @return true if every inner array came from allocate_zeroed as zero bits
+         * allocates an outer array and enough inner arrays to hold s elements with the
+         * logical array centered in them; _back always points into an allocated block
+         */
+        bool init_outer (size_type s) {
+            const size_type blocks = s / INNER_SIZE + 1;
+            const pointer_pointer outer = _outer_alloc.allocate(blocks);
+            if (_cow) {
+                try {
+                    _refs = _refs_alloc.allocate(blocks);}
+                catch (...) {
+                    _outer_alloc.deallocate(outer, blocks);
+                    throw;}}
+            _outer_pfront = _outer_lfront = _outer_lback = outer;
+            _outer_pback  = outer + blocks;
+            bool zeroed = true;
+            try {
+                for (; _outer_lback != _outer_pback; ++_outer_lback)
+                    zeroed = new_block(_outer_lback) && zeroed;}
+            catch (...) {
+                free_outer();
+                throw;}
+            const size_type skip = (blocks * INNER_SIZE - s) / 2;
+            _front = *_outer_lfront + skip;
+            _back  = *(_outer_lfront + (skip + s) / INNER_SIZE) + (skip + s) % INNER_SIZE;
+            return zeroed;}
+
+        // -------------
+        // reserve_outer
+        // -------------
+
+        /**
+         * @param f the number of free outer slots needed before the first block
+         * @param b the number of free outer slots needed after the last block
+         * recenters the block pointers if the outer array is less than half used, otherwise
+         * reallocates it at twice the size; only block pointers are copied, never elements,
+         * and a deque used as a queue never grows its outer array
+         */
+        void reserve_outer (size_type f, size_type b) {
+            if (size_type(_outer_lfront - _outer_pfront) >= f && size_type(_outer_pback - _outer_lback) >= b)
+                return;
+            const size_type used = _outer_lback - _outer_lfront;
+            const size_type size = _outer_pback - _outer_pfront;
+            if (size > 2 * (used + f + b)) {
+                pointer_pointer q = _outer_pfront + f + (size - used - f - b) / 2;
+                if (_refs) {
+                    count_pointer_pointer r = _refs + (_outer_lfront - _outer_pfront);
+                    if (q < _outer_lfront)
+                        std::copy(r, r + used, _refs + (q - _outer_pfront));
+                    else
+                        std::copy_backward(r, r + used, _refs + (q - _outer_pfront) + used);}
+                if (q < _outer_lfront)
+                    std::copy(_outer_lfront, _outer_lback, q);
+                else
+                    std::copy_backward(_outer_lfront, _outer_lback, q + used);
+                _outer_lfront = q;
+                _outer_lback  = q + used;
+                return;}
+            const size_type n = std::max<size_type>(2 * size, used + f + b);
+            pointer_pointer p = _outer_alloc.allocate(n);
+            pointer_pointer q = p + f + (n - used - f - b) / 2;
+            std::copy(_outer_lfront, _outer_lback, q);
+            if (_refs) {
+                count_pointer_pointer r = 0;
+                try {
+                    r = _refs_alloc.allocate(n);}
+                catch (...) {
+                    _outer_alloc.deallocate(p, n);
+                    throw;}
+                std::copy(_refs + (_outer_lfront - _outer_pfront), _refs + (_outer_lback - _outer_pfront), r + (q - p));
+                _refs_alloc.deallocate(_refs, _outer_pback - _outer_pfront);
+                _refs = r;}
+            _outer_alloc.deallocate(_outer_pfront, _outer_pback - _outer_pfront);
+            _outer_pfront = p;
+            _outer_lfront = q;
+            _outer_lback  = q + used;
+            _outer_pback  = p + n;}
+
+        // ---
+        // ref
+        // ---
+
+        /**
+         * @param p a slot of the outer array
+         * @return the reference count slot of the inner array at p
+         */
+        count_pointer& ref (pointer_pointer p) const {
+            return _refs[p - _outer_pfront];}
+
+        // -------
+        // sharers
+        // -------
+
+        /**
+         * @param p a slot of the outer array of a copy-on-write deque
+         * @return the number of deques that reference the inner array at p, read atomically
+         */
+        size_type sharers (pointer_pointer p) const {
+            return __sync_add_and_fetch(&*ref(p), 0);}
+
+        // ------
+        // shared
+        // ------
+
+        /**
+         * @param p a slot of the outer array
+         * @return true if the inner array at p is also referenced by another deque
+         */
+        bool shared (pointer_pointer p) const {
+            return _refs != 0 && sharers(p) > 1;}
+
+        // ----------
+        // make_count
+        // ----------
+
+        /**
+         * @return a reference count of one, for an inner array only this deque references
+         */
+        count_pointer make_count () {
+            const count_pointer r = _ref_alloc.allocate(1);
+            _ref_alloc.construct(r, 1);
+            return r;}
+
+        // ---------
+        // new_block
+        // ---------
+
+        /**
+         * @param p a free slot of the outer array
+         * @return true if the inner array came from allocate_zeroed as zero bits
+         * allocates an inner array into p, with a reference count in copy-on-write mode
+         */
+        bool new_block (pointer_pointer p) {
+            bool zeroed;
+            *p = allocate_zeroed(_inner_alloc, INNER_SIZE, zeroed);
+            if (_refs) {
+                try {
+                    ref(p) = make_count();}
+                catch (...) {
+                    _inner_alloc.deallocate(*p, INNER_SIZE);
+                    throw;}}
+            return zeroed;}
+
+        // ----
+        // drop
+        // ----
+
+        /**
+         * @param r the reference count of the inner array a
+         * @param b the first element of a this deque holds
+         * @param e one past the last
+         * drops this deque's reference to a; the deque that drops the last one destroys [b, e)
+         * and frees a, so a sharer may drop its reference on another thread at the same time
+         */
+        void drop (count_pointer r, pointer a, pointer b, pointer e) {
+            if (__sync_sub_and_fetch(&*r, 1) != 0)
+                return;
+            destroy(_inner_alloc, b, e);
+            _ref_alloc.deallocate(r, 1);
+            _inner_alloc.deallocate(a, INNER_SIZE);}
+
+        // -------
+        // unshare
+        // -------
+
+        /**
+         * @param p a slot of the outer array
+         * gives this deque its own copy of the inner array at p if another deque still references it;
+         * this must be called before any element in that inner array is written or destroyed
+         */
+        void unshare (pointer_pointer p) {
+            if (!shared(p))
+                return;
+            const pointer b     = (p == _outer_lfront)  ? _front : *p;
+            const pointer e     = (p == _outer_lback-1) ? _back  : *p + INNER_SIZE;
+            const pointer block = _inner_alloc.allocate(INNER_SIZE);
+            count_pointer r     = 0;
+            try {
+                r = make_count();
+                uninitialized_copy(_inner_alloc, b, e, block + (b - *p));}
+            catch (...) {
+                if (r)
+                    _ref_alloc.deallocate(r, 1);
+                _inner_alloc.deallocate(block, INNER_SIZE);
+                throw;}
+            const pointer old = *p;
+            if (p == _outer_lfront)
+                _front = block + (_front - old);
+            if (p == _outer_lback-1)
+                _back  = block + (_back - old);
+            *p = block;
+            std::swap(r, ref(p));
+            drop(r, old, b, e);}
+
+        // ----------
+        // free_block
+        // ----------
+
+        /**
+         * @param p a slot of the outer array
+         * @param b the first element this deque holds in the inner array at p
+         * @param e one past the last
+         * drops this deque's reference to the inner array at p; if no other deque references
+         * it, destroys [b, e) and frees it
+         */
+        void free_block (pointer_pointer p, pointer b, pointer e) {
+            if (_refs)
+                drop(ref(p), *p, b, e);
+            else {
+                destroy(_inner_alloc, b, e);
+                _inner_alloc.deallocate(*p, INNER_SIZE);}}
+
+        /**
+         * @param p a slot of the outer array that holds no element of this deque
+         */
+        void free_block (pointer_pointer p) {
+            free_block(p, *p, *p);}
+
+        // -----
+        // share
+        // -----
+
+        /**
+         * @param that a copy-on-write deque whose inner arrays this null deque is to reference
+         * O(blocks): copies the outer array of that and atomically bumps the reference count of
+         * every inner array; nothing else of that is written, but it must not be written meanwhile
+         */
+        void share (const Deque& that) {
+            const size_type       blocks = that._outer_lback - that._outer_lfront;
+            const pointer_pointer outer  = _outer_alloc.allocate(blocks);
+            try {
+                _refs = _refs_alloc.allocate(blocks);}
+            catch (...) {
+                _outer_alloc.deallocate(outer, blocks);
+                throw;}
+            _outer_pfront = _outer_lfront = outer;
+            _outer_pback  = _outer_lback  = outer + blocks;
+            for (size_type i = 0; i != blocks; ++i) {
+                const count_pointer r = that.ref(that._outer_lfront + i);
+                __sync_add_and_fetch(&*r, 1);
+                _refs[i] = r;
+                _outer_lfront[i] = that._outer_lfront[i];}
+            _front = that._front;
+            _back  = that._back;}
+
+        // --------
+        // exchange
+        // --------
+
+        /**
+         * @param that the deque with which to swap data
+         * swaps the data between this and that deque but leaves each with its own copy-on-write mode
+         */
+        void exchange (Deque& that) {
+            const bool a = _cow;
+            const bool b = that._cow;
+            swap(that);
+            set_copy_on_write(a);
+            that.set_copy_on_write(b);}
+
+        // ----
+        // fill
+        // ----
+
+        /**
+         * @param p the slot of the outer array whose inner array holds b
+         * @param b the first element to construct
+         * @param k the number of elements to construct
+         * @param v the value to construct them with
+         * constructs an inner array at a time through plain pointers rather than through
+         * iterators, destroying what it constructed if a construction throws
+         */
+        void fill (pointer_pointer p, pointer b, size_type k, const_reference v) {
+            pointer_pointer q = p;
+            pointer         x = b;
+            try {
+                while (k != 0) {
+                    const size_type m = std::min<size_type>(k, (*q + INNER_SIZE) - x);
+                    uninitialized_fill(_inner_alloc, x, x + m, v);
+                    k -= m;
+                    if (k != 0)
+                        x = *++q;}}
+            catch (...) {
+                while (q != p) {
+                    --q;
+                    destroy(_inner_alloc, (q == p) ? b : *q, *q + INNER_SIZE);}
+                throw;}}
+
+        // ------
+        // extend
+        // ------
+
+        /**
+         * @param k the number of elements to add to the end of this deque
+         * @param v the value used to fill them
+         * allocates every inner array needed up front, growing the outer array at most once;
+         * if v is zero bits, inner arrays that come zeroed are left as they are
+         */
+        void extend (size_type k, const_reference v) {
+            if (_outer_pfront == 0) {
+                const bool zeroed = init_outer(k);
+                try {
+                    if (!(zeroed && zero_bits(v)))
+                        fill(_outer_lfront, _front, k, v);}
+                catch (...) {
+                    free_outer();
+                    throw;}
+                return;}
+            unshare(_outer_lback-1);
+            const value_type      t      = v;
+            const size_type       off    = _back - *(_outer_lback-1) + k;
+            const size_type       blocks = off / INNER_SIZE;
+            reserve_outer(0, blocks);
+            const pointer_pointer last   = _outer_lback;
+            bool                  zeroed = zero_bits(t);
+            try {
+                for (size_type i = 0; i != blocks; ++i) {
+                    zeroed = new_block(_outer_lback) && zeroed;
+                    ++_outer_lback;}
+                fill(last-1, _back, zeroed ? std::min<size_type>(k, (*(last-1) + INNER_SIZE) - _back) : k, t);}
+            catch (...) {
+                while (_outer_lback != last) {
+                    --_outer_lback;
+                    free_block(_outer_lback);}
+                throw;}
+            _back = *(_outer_lback-1) + off % INNER_SIZE;}
+
+        // --------
+        // truncate
+        // --------
+
+        /**
+         * @param s the number of elements to keep
+         * destroys the elements after the first s and frees the inner arrays they leave empty
+         */
+        void truncate (size_type s) {
+            const size_type       pos  = (_front - *_outer_lfront) + s;
+            const pointer_pointer last = _outer_lfront + pos / INNER_SIZE;
+            unshare(last);
+            pointer e = _back;
+            while (_outer_lback-1 != last) {
+                free_block(_outer_lback-1, *(_outer_lback-1), e);
+                --_outer_lback;
+                e = *(_outer_lback-1) + INNER_SIZE;}
+            _back = *last + pos % INNER_SIZE;
+            destroy(_inner_alloc, _back, e);}
+
+        // ----
+        // slot
+        // ----
+
+        /**
+         * @param k a position counted from the start of the first inner array
+         * @return the address of that slot
+         */
+        pointer slot (size_type k) const {
+            return _outer_lfront[k / INNER_SIZE] + k % INNER_SIZE;}
+
+        // -------
+        // realign
+        // -------
+
+        /**
+         * @param d the number of slots to move every element by, toward the back if positive
+         * and toward the front if negative, less than INNER_SIZE either way
+         * moves the elements of this nonempty deque within its own inner arrays, so that a
+         * splice can line up its seam; it copies each element once and, past unsharing the
+         * inner arrays it writes, allocates at most one inner array and frees at most one;
+         * if a copy throws, the deque keeps its elements, but their values are unspecified
+         */
+        void realign (difference_type d) {
+            for (pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                unshare(p);
+            size_type f = _front - *_outer_lfront;
+            size_type b = f + size();
+            bool      added = false;
+            if (d > 0 && b + d >= size_type(_outer_lback - _outer_lfront) * INNER_SIZE) {
+                reserve_outer(0, 1);
+                new_block(_outer_lback);
+                ++_outer_lback;
+                added = true;}
+            else if (d < 0 && f < size_type(-d)) {
+                reserve_outer(1, 0);
+                new_block(_outer_lfront - 1);
+                --_outer_lfront;
+                f += INNER_SIZE;
+                b += INNER_SIZE;
+                added = true;}
+
+            //Construct the slots the elements move into that none holds yet, then assign the
+            //rest in the order that reads each one before it is overwritten, then destroy the
+            //slots left behind
+            const size_type s = (d > 0) ? d : -d;
+            const size_type c = (d > 0) ? std::max(b, f + s) : f - s;
+            const size_type e = (d > 0) ? b + s : std::min(f, b - s);
+            size_type       k = c;
+            try {
+                for (; k != e; ++k)
+                    _inner_alloc.construct(slot(k), *slot(d > 0 ? k - s : k + s));
+                if (d > 0)
+                    for (size_type j = c; j != f + s; --j)
+                        *slot(j - 1) = *slot(j - 1 - s);
+                else
+                    for (size_type j = e; j != b - s; ++j)
+                        *slot(j) = *slot(j + s);}
+            catch (...) {
+                while (k != c)
+                    _inner_alloc.destroy(slot(--k));
+                if (added && d > 0)
+                    free_block(--_outer_lback);
+                else if (added)
+                    free_block(_outer_lfront++);
+                throw;}
+            for (size_type j = (d > 0) ? f : std::max(f, b - s); j != ((d > 0) ? std::min(b, f + s) : b); ++j)
+                _inner_alloc.destroy(slot(j));
+            f = (d > 0) ? f + s : f - s;
+            b = (d > 0) ? b + s : b - s;
+
+            //Free an inner array the move emptied
+            if (f >= INNER_SIZE) {
+                free_block(_outer_lfront++);
+                f -= INNER_SIZE;
+                b -= INNER_SIZE;}
+            else if (b < size_type(_outer_lback - _outer_lfront - 1) * INNER_SIZE)
+                free_block(--_outer_lback);
+            _front = slot(f);
+            _back  = slot(b);}
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * destroys every element and frees every block and the outer array, leaving this deque null
+         */
+        void release () {
+            if (_outer_pfront == 0)
+                return;
+            for (pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                free_block(p, (p == _outer_lfront) ? _front : *p, (p == _outer_lback-1) ? _back : *p + INNER_SIZE);
+            _outer_lback = _outer_lfront;
+            free_outer();}
+
+        // ----------
+        // free_outer
+        // ----------
+
+        /**
+         * frees every block and the outer array without destroying any element, leaving this deque null
+         */
+        void free_outer () {
+            for (pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                free_block(p);
+            if (_refs)
+                _refs_alloc.deallocate(_refs, _outer_pback - _outer_pfront);
+            _outer_alloc.deallocate(_outer_pfront, _outer_pback - _outer_pfront);
+            _outer_pfront = _outer_pback = _outer_lfront = _outer_lback = 0;
+            _front = _back = 0;
+            _refs  = 0;}
+
+        // ----------
+        // push_bytes
+        // ----------
+
+        /**
+         * @param back true for push_back, false for push_front
+         * @return the bytes that push allocates: a copy of the inner array it writes to if
+         * that one is shared, a new inner array if the end one is full, a reference count for
+         * each of those when the inner arrays are counted, and a larger outer array if
+         * reserve_outer can't recenter
+         */
+        size_type push_bytes (bool back) const {
+            const size_type block = INNER_SIZE * sizeof(value_type) + (_refs ? sizeof(size_type) : 0);
+            if(_outer_pfront == 0)
+                return sizeof(pointer) + block;
+            const bool      fresh = back ? capacity_back() == 0 : capacity_front() == 0;
+            const size_type copy  = ((back || !fresh) && shared(back ? _outer_lback-1 : _outer_lfront)) ? block : 0;
+            if(!fresh)
+                return copy;
+            const size_type room = back ? _outer_pback - _outer_lback : _outer_lfront - _outer_pfront;
+            const size_type used = _outer_lback - _outer_lfront;
+            const size_type size = _outer_pback - _outer_pfront;
+            if(room != 0 || size > 2 * (used + 1))
+                return copy + block;
+            const size_type n = std::max<size_type>(2 * size, used + 1);
+            return copy + block + n * (sizeof(pointer) + (_refs ? sizeof(count_pointer) : 0));}
+
+        // --------------
+        // prefetch_ahead
+        // --------------
+
+        /**
+         * @param index the position an iterator has just stepped to
+         * @return the position at which the next block starts
+         * if index starts a block, prefetches the block four ahead of it, so a
+         * scan doesn't wait on blocks that are scattered in memory; iterators
+         * call this only when they reach the position it last returned
+         */
+        size_type prefetch_ahead (size_type index) const {
+            const size_type i = index + (_front - *_outer_lfront);
+            const size_type r = i % INNER_SIZE;
+            if (r == 0) {
+                const pointer_pointer p = _outer_lfront + i / INNER_SIZE + 4;
+                if (p < _outer_lback)
+                    prefetch(*p);}
+            return index - r + INNER_SIZE;}
 
     public:
         // --------
@@ -201,6 +862,8 @@ class Deque {
                 friend iterator operator - (iterator lhs, difference_type rhs) {
                     return lhs -= rhs;}
 
+                friend class Deque;
+
             private:
                 // ----
                 // data
@@ -209,6 +872,11 @@ class Deque {
                 size_type _index;
                 Deque* _deque;
 
+                /**
+                 * the position at which ++ next crosses into a block and prefetches
+                 */
+                size_type _next;
+
             private:
                 // -----
                 // valid
@@ -226,7 +894,7 @@ class Deque {
                 /**
                  * Default constructor that creates an iterator and a deque
                  */
-                iterator (size_type index, Deque* deque) : _index(index), _deque(deque) {
+                iterator (size_type index, Deque* deque) : _index(index), _deque(deque), _next(0) {
                     assert(valid());}
 
                 // Default copy, destructor, and copy assignment.
@@ -262,7 +930,8 @@ class Deque {
                  * Preincrement operator adds one to the index.
                  */
                 iterator& operator ++ () {
-                    ++_index;
+                    if (++_index >= _next)
+                        _next = _deque->prefetch_ahead(_index);
                     assert(valid());
                     return *this;}
 
@@ -307,6 +976,7 @@ class Deque {
                  */
                 iterator& operator += (difference_type d) {
                     _index += d;
+                    _next   = 0;
                     assert(valid());
                     return *this;}
 
@@ -319,6 +989,7 @@ class Deque {
                  */
                 iterator& operator -= (difference_type d) {
                     _index -= d;
+                    _next   = 0;
                     assert(valid());
                     return *this;}};
 
@@ -378,6 +1049,11 @@ class Deque {
                 size_type _index;
                 const Deque* _deque;
 
+                /**
+                 * the position at which ++ next crosses into a block and prefetches
+                 */
+                size_type _next;
+
             private:
                 // -----
                 // valid
@@ -395,7 +1071,7 @@ class Deque {
                 /**
                  * make a read-only iterator
                  */
-                const_iterator (size_type index, const Deque* deque) : _index(index), _deque(deque) {
+                const_iterator (size_type index, const Deque* deque) : _index(index), _deque(deque), _next(0) {
                     assert(valid());}
 
                 // Default copy, destructor, and copy assignment.
@@ -431,7 +1107,8 @@ class Deque {
                  * Pre increment adds one to the current value
                  */
                 const_iterator& operator ++ () {
-                    ++_index;
+                    if (++_index >= _next)
+                        _next = _deque->prefetch_ahead(_index);
                     assert(valid());
                     return *this;}
 
@@ -475,6 +1152,7 @@ class Deque {
                  */
                 const_iterator& operator += (difference_type d) {
                     _index += d;
+                    _next   = 0;
                     assert(valid());
                     return *this;}
 
@@ -488,6 +1166,7 @@ class Deque {
                  */
                 const_iterator& operator -= (difference_type d) {
                     _index -= d;
+                    _next   = 0;
                     assert(valid());
                     return *this;}};
 
@@ -501,9 +1180,9 @@ class Deque {
          * @param a the allocator for this deque
          * constructs an empty deque
          */
-        explicit Deque (const allocator_type& a = allocator_type()) : _inner_alloc(a), INNER_SIZE(10) {
-        	_outer_pfront = _outer_pback = _outer_lfront = _outer_lback = 0;
-        	_front = _back = 0;
+        explicit Deque (const allocator_type& a = allocator_type()) : INNER_SIZE(10), _inner_alloc(a), _outer_alloc(a), _ref_alloc(a), _refs_alloc(a), _refs(0), _cow(false) {
+            _outer_pfront = _outer_pback = _outer_lfront = _outer_lback = 0;
+            _front = _back = 0;
             assert(valid());}
 
         /**
@@ -511,51 +1190,28 @@ class Deque {
          * @param s the initial size of this deque
          * @param v the value used to fill the initial elements
          * @param a the allocator for this deque
-         * constructs a deque of size s filled with value v
-         */
-        explicit Deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) : _inner_alloc(a), INNER_SIZE(10) {
-		// Keeps track in the even that we have a non divisible size by 10 to add an extra spot in the physical array
-		size_type numInArray = s/INNER_SIZE+(s%INNER_SIZE ==0 ? 0:1);
-        	pointer_pointer start = _outer_pfront = _outer_lfront = _outer_alloc.allocate(numInArray);
-        	size_type allocated = 0,skip;
-        	_outer_pback = _outer_lback = _outer_pfront + numInArray;
-
-		//Creating Inner Arrays
-        	while(start < _outer_pback) {
-	        	*start = _inner_alloc.allocate(INNER_SIZE);
-	        	allocated += INNER_SIZE;
-                ++start;
-        	}
-
-		//Total number of spaces allocated minus the number of the size requested divided by 2 to help make it center loaded. 
-        	skip = (allocated - s)/2;
-
-		//Set the logical array pointers
-        	_front = (*_outer_lfront)+skip;
-        	_back = *(_outer_lback-1)+(INNER_SIZE-((allocated-s)-skip));
-
-		//Fill the array with the user's v
-        	uninitialized_fill(_inner_alloc,begin(),end(),v);
+         * constructs a deque of size s filled with value v; if v is zero bits and the
+         * allocator hands out zeroed inner arrays, they aren't written at all
+         */
+        explicit Deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) : INNER_SIZE(10), _inner_alloc(a), _outer_alloc(a), _ref_alloc(a), _refs_alloc(a), _refs(0), _cow(false) {
+            if (!(init_outer(s) && zero_bits(v)))
+                fill(_outer_lfront, _front, s, v);
             assert(valid());}
 
         /**
          * Copy Constructor
          * @param the deque to copy into this deque
+         * if that is copy-on-write, the copy is too and shares its inner arrays in O(blocks);
+         * a copy of a deque that has never allocated doesn't allocate either
          */
-        Deque (const Deque& that) : _inner_alloc(that._inner_alloc), _outer_alloc(that._outer_alloc), INNER_SIZE(10) {
-	        size_type s = that.size();
-            pointer_pointer start = _outer_pfront = _outer_lfront = _outer_alloc.allocate(s/INNER_SIZE);
-        	size_type allocated = 0, skip;
-        	_outer_pback = _outer_lback = _outer_pfront + s/INNER_SIZE;
-        	while(start < _outer_pback) {
-	        	*start = _inner_alloc.allocate(INNER_SIZE);
-	        	allocated += INNER_SIZE;
-                ++start;
-        	}
-        	skip = (allocated - s)/2;
-        	_front = (*_outer_lfront)+skip;
-        	_back = *(_outer_lback-1)+(INNER_SIZE-((allocated-s)-skip));
-        	uninitialized_copy(_inner_alloc,that.begin(),that.end(),begin());
+        Deque (const Deque& that) : INNER_SIZE(10), _inner_alloc(that._inner_alloc), _outer_alloc(that._outer_alloc), _ref_alloc(that._ref_alloc), _refs_alloc(that._refs_alloc), _refs(0), _cow(that._cow) {
+            _outer_pfront = _outer_pback = _outer_lfront = _outer_lback = 0;
+            _front = _back = 0;
+            if (_cow && that._outer_pfront != 0)
+                share(that);
+            else if (that._outer_pfront != 0) {
+                init_outer(that.size());
+                uninitialized_copy(_inner_alloc, that.begin(), that.end(), begin());}
             assert(valid());}
 
         // ----------
@@ -566,16 +1222,7 @@ class Deque {
          * Destructor
          */
         ~Deque () {
-            while(!empty())
-                pop_back();
-            while(_outer_lfront < _outer_lback) {
-            	_inner_alloc.deallocate(*_outer_lfront,INNER_SIZE);
-            	_outer_alloc.destroy(_outer_lfront);
-            	++_outer_lfront;
-        	}
-        	_outer_alloc.deallocate(_outer_pfront,_outer_pback-_outer_pfront);
-        	_outer_pfront = _outer_pback = _outer_lfront = _outer_lback = 0;
-        	_front = _back = 0;
+            release();
             assert(valid());}
 
         // ----------
@@ -584,12 +1231,15 @@ class Deque {
 
         /**
          * Assignment Operator: Copies the elements of parameter deque to our current deque.
+         * If rhs is copy-on-write, this deque becomes copy-on-write and shares its inner arrays instead.
          */
         Deque& operator = (const Deque& rhs) {
-           
-	   resize(rhs.size());
-	   std::copy(rhs.begin(), rhs.end(), begin());
-		
+            if (rhs._cow && this != &rhs && _inner_alloc == rhs._inner_alloc && _outer_alloc == rhs._outer_alloc) {
+                Deque that(rhs);
+                swap(that);}
+            else {
+                resize(rhs.size());
+                std::copy(rhs.begin(), rhs.end(), begin());}
             assert(valid());
             return *this;}
 
@@ -602,21 +1252,18 @@ class Deque {
          * @return a reference to that element
          */
         reference operator [] (size_type index) {
-            std::cout << _outer_lfront << " " << index << std::endl;
-	        difference_type offset = _front - *_outer_lfront;
-                std::cout << "got here" << std::endl;
-                pointer_pointer y = _outer_lfront+(index+offset)/INNER_SIZE;
-                std::cout << "y is " << y << " : " << _outer_lfront << " + ( " << index << " + " << offset << " ) / " << INNER_SIZE << std::endl;
-                pointer x = *(y);
-                std::cout << "x is " << x << std::endl;
-            return *( x + (((index%INNER_SIZE)+offset)%INNER_SIZE) );}
+            const size_type       i = index + (_front - *_outer_lfront);
+            const pointer_pointer p = _outer_lfront + i / INNER_SIZE;
+            unshare(p);
+            return *(*p + i % INNER_SIZE);}
 
         /**
          * @param index the index of the element to return
          * @return a constant reference to that element
          */
         const_reference operator [] (size_type index) const {
-            return const_cast<Deque*>(this)->operator[](index);}
+            const size_type i = index + (_front - *_outer_lfront);
+            return *(*(_outer_lfront + i / INNER_SIZE) + i % INNER_SIZE);}
 
         // --
         // at
@@ -628,7 +1275,7 @@ class Deque {
          * @throw invalid_argument if the index is invalid
          */
         reference at (size_type index) {
-            if(index < 0 || index >= size())
+            if(index >= size())
                 throw std::invalid_argument("deque::_M_range_check");
             return operator[](index);}
 
@@ -638,7 +1285,9 @@ class Deque {
          * @throw invalid_argument if the index is invalid
          */
         const_reference at (size_type index) const {
-            return const_cast<Deque*>(this)->at(index);}
+            if(index >= size())
+                throw std::invalid_argument("deque::_M_range_check");
+            return operator[](index);}
 
         // ----
         // back
@@ -654,7 +1303,7 @@ class Deque {
          * @return a constant reference to the last element in this deque
          */
         const_reference back () const {
-            return const_cast<Deque*>(this)->back();}
+            return *(end()-1);}
 
         // -----
         // begin
@@ -672,6 +1321,24 @@ class Deque {
         const_iterator begin () const {
             return const_iterator(0,this);}
 
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return the number of elements push_back can add before it allocates an inner array
+         */
+        size_type capacity_back () const {
+            if(_outer_pfront==0) return 0;
+            return (*(_outer_lback-1) + INNER_SIZE) - _back - 1;}
+
+        /**
+         * @return the number of elements push_front can add before it allocates an inner array
+         */
+        size_type capacity_front () const {
+            if(_outer_pfront==0) return 0;
+            return _front - *_outer_lfront;}
+
         // -----
         // clear
         // -----
@@ -681,7 +1348,7 @@ class Deque {
          */
         void clear () {
             while(size())
-            	pop_back();
+                pop_back();
             assert(valid());}
 
         // -----
@@ -716,20 +1383,26 @@ class Deque {
 
         /**
          * @param i is the location to be erased
-	 * @return i to show the iterator the process was completed.
+         * @return i to show the iterator the process was completed.
+         * shifts the elements on the shorter side of i, so it costs O(min(i, size() - i)) assignments
          */
         iterator erase (iterator i) {
-      
-	     	iterator x = i;
-		
-		//Swap the next element into the current position
-		while(x != (end()-1)){
-		*x = *x+1;
-		++x;
-		}
-		
-		pop_back();
-	
+            const size_type n = size();
+            iterator x = i;
+
+            //Shift the elements before i back by one and drop the first
+            if(i._index < n / 2) {
+                while(x != begin()) {
+                    *x = *(x-1);
+                    --x;}
+                pop_front();}
+
+            //Shift the elements after i forward by one and drop the last
+            else {
+                while(x != (end()-1)) {
+                    *x = *(x+1);
+                    ++x;}
+                pop_back();}
             assert(valid());
             return i;}
 
@@ -747,7 +1420,7 @@ class Deque {
          * @return a constant reference to the first element of this deque
          */
         const_reference front () const {
-            return const_cast<Deque*>(this)->front();}
+            return *begin();}
 
         // ------
         // insert
@@ -755,25 +1428,62 @@ class Deque {
 
         /**
          * @param  i to be the target location for the deque
-	 * @param  v the value to be inserted
-	 * @return i back to the user to show process was completed
+         * @param  v the value to be inserted
+         * @return i back to the user to show process was completed
+         * shifts the elements on the shorter side of i, so it costs O(min(i, size() - i)) assignments
          */
         iterator insert (iterator i, const_reference v) {
-            
-	    push_back(v);
-	    iterator x = end();
-	
-	//Iterate from the back of the array and keep swapping until you reach your desired location
-	    while(x != i){
-		--x;
-		*x = *(x-1);
-		}
-
-	    *i = v;
-	
+            const size_type n = size();
+            if(i._index == 0) {
+                push_front(v);
+                return begin();}
+            if(i._index == n) {
+                push_back(v);
+                return end()-1;}
+            const value_type t = v;
+
+            //Duplicate the first element and shift the elements before i forward until you reach your desired location
+            if(i._index < n / 2) {
+                push_front(front());
+                iterator x = begin()+1;
+                while(x != i) {
+                    *x = *(x+1);
+                    ++x;}}
+
+            //Iterate from the back of the array and keep shifting until you reach your desired location
+            else {
+                push_back(back());
+                iterator x = end()-2;
+                while(x != i) {
+                    *x = *(x-1);
+                    --x;}}
+
+            *i = t;
             assert(valid());
             return i;}
 
+        // ----------------
+        // memory_footprint
+        // ----------------
+
+        /**
+         * @return the bytes held by this deque: the object itself, the whole outer array,
+         * and every inner array it references, including the unused slots at either end;
+         * when the inner arrays are counted, it adds the array of counts and charges each
+         * inner array and its count split evenly among its sharers, so the footprints of a
+         * deque and its snapshots add up to what they hold together, and it costs O(blocks)
+         */
+        size_type memory_footprint () const {
+            const size_type slots  = _outer_pback - _outer_pfront;
+            const size_type blocks = _outer_lback - _outer_lfront;
+            const size_type block  = INNER_SIZE * sizeof(value_type);
+            if(!_refs)
+                return sizeof(Deque) + slots * sizeof(pointer) + blocks * block;
+            size_type n = sizeof(Deque) + slots * (sizeof(pointer) + sizeof(count_pointer));
+            for(pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                n += (block + sizeof(size_type)) / sharers(p);
+            return n;}
+
         // ---
         // pop
         // ---
@@ -782,39 +1492,33 @@ class Deque {
          * removes the last element of this deque
          */
         void pop_back () {
-           // Destroy the last element.
-	   _inner_alloc.destroy(_back-1);
-		
-	   //Change the outer back pointer to previous array and point to the last element of the previous array
-	   if(_back == *(_outer_lback-1)){
-		_inner_alloc.deallocate(*(_outer_lback -1), INNER_SIZE);
-		--_outer_lback;
-		_back = *(_outer_lback-1) + INNER_SIZE;
-		}
-	   else{
-		--_back;}
-
-	}
+            assert(!empty());
+
+            //Step back into the previous inner array, freeing the now unused last one
+            if(_back == *(_outer_lback-1)) {
+                free_block(_outer_lback-1);
+                --_outer_lback;
+                _back = *(_outer_lback-1) + INNER_SIZE;}
+            unshare(_outer_lback-1);
+            --_back;
+            _inner_alloc.destroy(_back);
+            assert(valid());}
 
         /**
          * removes the first element of this deque
          */
         void pop_front () {
+            assert(!empty());
 
-		// Destroy the first element 
-	      	_inner_alloc.destroy(_front);
-
-	     // Change the outer front pointer to next array and point to the first element in the next array
-             if(_front == *_outer_lfront - (INNER_SIZE -1) ){
-		_inner_alloc.deallocate(*_outer_lfront,INNER_SIZE);
-		++_outer_lfront;
-		_front = *_outer_lfront;}
-
-	    //Otherwise the front is not at the end of the inner array
-	    else{
-		++_front;};
-	    
-		
+            //Step into the next inner array, freeing the now empty first one
+            if(_front + 1 == *_outer_lfront + INNER_SIZE) {
+                free_block(_outer_lfront, _front, _front + 1);
+                ++_outer_lfront;
+                _front = *_outer_lfront;}
+            else {
+                unshare(_outer_lfront);
+                _inner_alloc.destroy(_front);
+                ++_front;}
             assert(valid());}
 
         // ----
@@ -826,58 +1530,24 @@ class Deque {
          * adds e to the end of the deque
          */
         void push_back (const_reference e) {
-
-	//If our pointers are null, make a deque
-           if(_outer_pfront == 0){
-		_outer_pfront = _outer_lfront = _outer_alloc.allocate(1);
-		_outer_pback = _outer_lback = _outer_pfront+1;
-		
-		*_outer_lfront = _inner_alloc.allocate(INNER_SIZE);
-	
-		//Make it center loaded
-		_front = *_outer_lfront +(INNER_SIZE/2);
-
-		_back  = _front +1;	
-		
-		*_front = e;
-		}
-
-	//If you already have some space in the back of the array
-	else if(_back != *(_outer_lback -1) + INNER_SIZE){
-	
-		*_back = e;
-
-		++_back;}
-
-	//Else you are at your last element of the last inner array. Time to resize.
-	else{
-		
-	//Check to see if you have space in the physical array
-	if(_outer_lback == _outer_pback){
-	difference_type newsize = 2*(_outer_pback - _outer_pfront);
-	pointer_pointer tempfront =  _outer_alloc.allocate(newsize);
-	pointer_pointer temp = tempfront;
-	pointer_pointer tempiterator = _outer_pfront;
-	
-	//Copy current elements
-	while(tempiterator != _outer_pback){
-		_outer_alloc.construct(temp, *tempiterator);
-		_outer_alloc.destroy(tempiterator);
-		++temp;
-		++tempiterator;}
-	_outer_alloc.deallocate(_outer_pfront,(_outer_pback-_outer_pfront));
-
-	_outer_pfront = _outer_lfront = tempfront;
-	_outer_lback = temp;
-	_outer_pback = tempfront + newsize;}
-
-	//add the e
-	++_outer_lback;
-	_back = *(_outer_lback -1);
-	*_back = e;
-	++_back;
-	}
-		
+            if(_outer_pfront == 0)
+                init_outer(0);
+            unshare(_outer_lback-1);
+
+            //The last slot of the last inner array needs a new inner array after it for _back
+            if(_back + 1 == *(_outer_lback-1) + INNER_SIZE) {
+                reserve_outer(0, 1);
+                new_block(_outer_lback);
+                try {
+                    _inner_alloc.construct(_back, e);}
+                catch (...) {
+                    free_block(_outer_lback);
+                    throw;}
+                ++_outer_lback;
+                _back = *(_outer_lback-1);}
+            else {
+                _inner_alloc.construct(_back, e);
+                ++_back;}
             assert(valid());}
 
         /**
@@ -885,61 +1555,24 @@ class Deque {
          * adds e to the beginning of the deque
          */
         void push_front (const_reference e) {
-      	   //If our pointers are null, make a deque
-           if(_outer_pfront == 0){
-		_outer_pfront = _outer_lfront = _outer_alloc.allocate(1);
-		_outer_pback = _outer_lback = _outer_pfront+1;
-		
-		*_outer_lfront = _inner_alloc.allocate(INNER_SIZE);
-	
-		//Make it center loaded
-		_front = *_outer_lfront +(INNER_SIZE/2);
-
-		_back  = _front +1;	
-		
-		*_front = e;
-		}
-
-	//Else if there is space, add it to the front of the inner array
-          else if(_front != *_outer_lfront){
-		  
-		 --_front;
-		 *_front = e;}
-
-	//Else we are at the beginning of the inner array
-
-	else{
-	
-		if(_outer_lfront == _outer_pfront){
-		difference_type newsize = 2*(_outer_pback - _outer_pfront);
-		pointer_pointer tempfront =  _outer_alloc.allocate(newsize);
-		pointer_pointer temp = tempfront + newsize;
-		pointer_pointer tempiterator = _outer_pback;
-
-		//Copy our elements
-
-		while(tempiterator != _outer_pfront){
-
-		--tempiterator;
-		--temp;
-		
-		_outer_alloc.construct(temp, *tempiterator);
-		_outer_alloc.destroy(tempiterator);
-		}
-		_outer_alloc.deallocate(_outer_pfront,(_outer_pback-_outer_pfront));
-	
-		_outer_pfront = tempfront;
-		_outer_pback  = _outer_lback = tempfront + newsize;
-		_outer_lfront  = temp;
-
-		}
-		--_outer_lfront;		
-		_front = *_outer_lfront + (INNER_SIZE-1);
-
-		*_front = e;
-
-		}
-
+            if(_outer_pfront == 0)
+                init_outer(0);
+
+            //At the beginning of the first inner array, so add a new inner array in front of it
+            if(_front == *_outer_lfront) {
+                reserve_outer(1, 0);
+                new_block(_outer_lfront-1);
+                try {
+                    _inner_alloc.construct(*(_outer_lfront-1) + (INNER_SIZE-1), e);}
+                catch (...) {
+                    free_block(_outer_lfront-1);
+                    throw;}
+                --_outer_lfront;
+                _front = *_outer_lfront + (INNER_SIZE-1);}
+            else {
+                unshare(_outer_lfront);
+                _inner_alloc.construct(_front-1, e);
+                --_front;}
             assert(valid());}
 
         // ------
@@ -954,15 +1587,11 @@ class Deque {
          * value v to the end of the deque if the new size is larger
          */
         void resize (size_type s, const_reference v = value_type()) {
-            size_type my_size = size();
-            while(s < my_size) {
-                pop_back();
-                --my_size;
-            }
-            while(s > my_size) {
-                push_back(v);
-                ++my_size;
-            }
+            const size_type n = size();
+            if(s < n)
+                truncate(s);
+            else if(s > n)
+                extend(s - n, v);
             assert(valid());}
 
         // ----
@@ -976,6 +1605,218 @@ class Deque {
             if(_outer_pfront==0) return 0;
             return ((_outer_lback - _outer_lfront)*INNER_SIZE) - (_front - *_outer_lfront) - ((*(_outer_lback-1)+INNER_SIZE) - _back);}
 
+        // ------
+        // splice
+        // ------
+
+        /**
+         * @param that the deque whose elements are appended to this deque; it is left empty
+         * with equal allocators, moves the inner arrays of that onto the end of the outer array
+         * and copies at most one inner array of elements at the seam; every inner array but the
+         * end ones must be full, so when the end of this deque doesn't fall at the same offset
+         * in its inner array as the beginning of that, the smaller of the two is first realigned
+         * within its own inner arrays, one copy per element and at most one allocation; so it
+         * costs O(blocks of that) when the seam lines up and O(min(size(), that.size())) copies
+         * when it doesn't; with unequal allocators every element of that is moved, in
+         * O(that.size())
+         */
+        void splice_back (Deque& that) {
+            assert(&that != this);
+            if(that.empty())
+                return;
+            if(!(_inner_alloc == that._inner_alloc && _outer_alloc == that._outer_alloc)) {
+                while(!that.empty()) {
+                    push_back(that.front());
+                    that.pop_front();}
+                return;}
+            if(empty()) {
+                exchange(that);
+                return;}
+
+            const difference_type p = _back - *(_outer_lback-1);
+            const difference_type q = that._front - *that._outer_lfront;
+            if(p != q) {
+                if(that.size() <= size())
+                    that.realign(p - q);
+                else
+                    realign(q - p);}
+
+            //Make room for the inner arrays of that before anything is copied or destroyed,
+            //and give that our mode, so its inner arrays have reference counts if ours do
+            const bool      cow    = that._cow;
+            const bool      single = (that._outer_lback - that._outer_lfront == 1);
+            const size_type blocks = that._outer_lback - that._outer_lfront - 1;
+            reserve_outer(0, blocks);
+            unshare(_outer_lback-1);
+            that.set_copy_on_write(_cow);
+            that.unshare(that._outer_lfront);
+
+            //Copy the elements of the first inner array of that into the same slots of our last one
+            const pointer seam = single ? that._back : *that._outer_lfront + INNER_SIZE;
+            uninitialized_copy(_inner_alloc, that._front, seam, _back);
+            destroy(_inner_alloc, that._front, seam);
+            if(single) {
+                _back += seam - that._front;
+                that._outer_lback = that._outer_lfront + 1;
+                that.free_outer();
+                that._cow = cow;
+                assert(valid());
+                return;}
+
+            //Our last inner array is now full, so take over the remaining inner arrays of that
+            std::copy(that._outer_lfront + 1, that._outer_lback, _outer_lback);
+            for (size_type i = 0; _refs != 0 && i != blocks; ++i)
+                ref(_outer_lback + i) = that.ref(that._outer_lfront + 1 + i);
+            _outer_lback += blocks;
+            _back = that._back;
+            that._outer_lback = that._outer_lfront + 1;
+            that.free_outer();
+            that._cow = cow;
+            assert(valid());}
+
+        /**
+         * @param that the deque whose elements are prepended to this deque; it is left empty
+         * the mirror image of splice_back, with the same costs: O(blocks of that) when the
+         * seams line up, O(min(size(), that.size())) copies when they don't, O(that.size())
+         * with unequal allocators
+         */
+        void splice_front (Deque& that) {
+            assert(&that != this);
+            if(!(_inner_alloc == that._inner_alloc && _outer_alloc == that._outer_alloc)) {
+                while(!that.empty()) {
+                    push_front(that.back());
+                    that.pop_back();}
+                return;}
+            const bool cow = that._cow;
+            that.set_copy_on_write(_cow);
+            that.splice_back(*this);
+            exchange(that);
+            that.set_copy_on_write(cow);
+            assert(valid());}
+
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * @param i   an iterator into this deque
+         * @param that the deque that receives [i, end()); its previous elements are destroyed
+         * with equal allocators, moves the inner arrays after the one holding i into that and
+         * copies only the elements of the inner array holding i, so it costs O(blocks after i)
+         * plus at most INNER_SIZE copies whatever the offset of i; with unequal allocators
+         * every element of [i, end()) is moved, in O(size() - i)
+         */
+        void split_at (iterator i, Deque& that) {
+            assert(i._deque == this && &that != this);
+            that.release();
+            const size_type n = i._index;
+            if(n == size())
+                return;
+            if(!(_inner_alloc == that._inner_alloc && _outer_alloc == that._outer_alloc)) {
+                while(end() != i) {
+                    that.push_front(back());
+                    pop_back();}
+                return;}
+
+            const size_type       off    = n + (_front - *_outer_lfront);
+            const pointer_pointer b      = _outer_lfront + off / INNER_SIZE;
+            unshare(b);
+            for (pointer_pointer p = b + 1; !that._cow && p != _outer_lback; ++p)
+                unshare(p);
+            const pointer         first  = *b + off % INNER_SIZE;
+            const pointer         last   = (b == _outer_lback-1) ? _back : *b + INNER_SIZE;
+            const size_type       blocks = _outer_lback - b;
+
+            //That gets a copy of the inner array holding i and the inner arrays after it
+            //A copy-on-write that takes over our reference counts, or makes new ones if we have none
+            const pointer_pointer outer = that._outer_alloc.allocate(blocks);
+            count_pointer_pointer refs  = 0;
+            size_type             k     = 0;
+            pointer               block = 0;
+            try {
+                if(that._cow) {
+                    refs = that._refs_alloc.allocate(blocks);
+                    for (; k != blocks; ++k)
+                        refs[k] = (k != 0 && _refs) ? ref(b + k) : make_count();}
+                block = _inner_alloc.allocate(INNER_SIZE);
+                uninitialized_copy(_inner_alloc, first, last, block + (first - *b));}
+            catch (...) {
+                if(block)
+                    _inner_alloc.deallocate(block, INNER_SIZE);
+                while(k != 0) {
+                    --k;
+                    if(k == 0 || !_refs)
+                        _ref_alloc.deallocate(refs[k], 1);}
+                if(refs)
+                    that._refs_alloc.deallocate(refs, blocks);
+                that._outer_alloc.deallocate(outer, blocks);
+                throw;}
+            that._outer_pfront = that._outer_lfront = outer;
+            that._outer_pback  = that._outer_lback  = that._outer_pfront + blocks;
+            *that._outer_lfront = block;
+            std::copy(b + 1, _outer_lback, that._outer_lfront + 1);
+            if(that._cow)
+                that._refs = refs;
+            else
+                for (pointer_pointer p = b + 1; _refs != 0 && p != _outer_lback; ++p)
+                    _ref_alloc.deallocate(ref(p), 1);
+            that._front = block + (first - *b);
+            that._back  = (blocks == 1) ? block + (last - *b) : _back;
+
+            destroy(_inner_alloc, first, last);
+            _outer_lback = b + 1;
+            _back = first;
+            assert(valid());
+            assert(that.valid());}
+
+        // -----------------
+        // set_copy_on_write
+        // -----------------
+
+        /**
+         * @param b whether copies of this deque should share its inner arrays
+         * in copy-on-write mode the copy constructor and operator = take O(blocks) and share
+         * inner arrays by reference count; an inner array is copied the first time one of its
+         * sharers writes to it through operator [], an iterator, push, pop, splice or split;
+         * turning the mode off gives this deque its own copy of every shared inner array.
+         * Each copy invalidates, for writing, the references and pointers into this deque
+         * obtained before it, as the class comment explains.
+         * The writer allocates a reference count for each inner array, and the counts are only
+         * changed atomically, so a snapshot may be read and destroyed on another thread while
+         * this deque is written; taking the snapshot only reads this deque, but must not run
+         * at the same time as a write to it
+         */
+        void set_copy_on_write (bool b) {
+            if(b == _cow)
+                return;
+            if(_outer_pfront != 0 && b) {
+                _refs = _refs_alloc.allocate(_outer_pback - _outer_pfront);
+                pointer_pointer p = _outer_lfront;
+                try {
+                    for (; p != _outer_lback; ++p)
+                        ref(p) = make_count();}
+                catch (...) {
+                    while(p != _outer_lfront)
+                        _ref_alloc.deallocate(ref(--p), 1);
+                    _refs_alloc.deallocate(_refs, _outer_pback - _outer_pfront);
+                    _refs = 0;
+                    throw;}}
+            else if(_outer_pfront != 0) {
+                for (pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                    unshare(p);
+                for (pointer_pointer p = _outer_lfront; p != _outer_lback; ++p)
+                    _ref_alloc.deallocate(ref(p), 1);
+                _refs_alloc.deallocate(_refs, _outer_pback - _outer_pfront);
+                _refs = 0;}
+            _cow = b;
+            assert(valid());}
+
+        /**
+         * @return true if copies of this deque share its inner arrays
+         */
+        bool copy_on_write () const {
+            return _cow;}
+
         // ----
         // swap
         // ----
@@ -986,18 +1827,60 @@ class Deque {
          */
         void swap (Deque& that) {
             if(_inner_alloc == that._inner_alloc && _outer_alloc == that._outer_alloc) {
-	            std::swap(_outer_pfront,that._outer_pfront);
-	            std::swap(_outer_lfront,that._outer_lfront);
-	            std::swap(_outer_pback, that._outer_pback);
-	            std::swap(_outer_lback, that._outer_lback);
-	            std::swap(_front,       that._front);
-	            std::swap(_back,        that._back);
+                std::swap(_outer_pfront,that._outer_pfront);
+                std::swap(_outer_lfront,that._outer_lfront);
+                std::swap(_outer_pback, that._outer_pback);
+                std::swap(_outer_lback, that._outer_lback);
+                std::swap(_front,       that._front);
+                std::swap(_back,        that._back);
+                std::swap(_refs,        that._refs);
+                std::swap(_cow,         that._cow);
             }
             else {
-	            Deque temp(*this);
-	            *this = that;
-	            that = temp;
+                Deque temp(*this);
+                *this = that;
+                that = temp;
             }
-            assert(valid());}};
+            assert(valid());}
+
+        // --------
+        // try_push
+        // --------
+
+        /**
+         * @param e the element to add
+         * @return true if e was added to the end of this deque, false if the allocator
+         * refused memory for it, in which case the elements of this deque are unchanged
+         */
+        bool try_push_back (const_reference e) {
+            const size_type n = push_bytes(true);
+            if(n != 0 && !can_allocate(_inner_alloc, n))
+                return false;
+            try {
+                push_back(e);}
+            catch (const std::bad_alloc&) {
+                return false;}
+            return true;}
+
+        /**
+         * @param e the element to add
+         * @return true if e was added to the beginning of this deque, false if the allocator
+         * refused memory for it, in which case the elements of this deque are unchanged
+         */
+        bool try_push_front (const_reference e) {
+            const size_type n = push_bytes(false);
+            if(n != 0 && !can_allocate(_inner_alloc, n))
+                return false;
+            try {
+                push_front(e);}
+            catch (const std::bad_alloc&) {
+                return false;}
+            return true;}};
+
+// -----------
+// Deque<bool>
+// -----------
+
+#include "DequeBool.h"
 
 #endif // Deque_h
@@ -0,0 +1,960 @@
+// --------------------------
+// projects/deque/DequeBool.h
+// --------------------------
+
+// Included by Deque.h, after the primary template, so that every user of
+// Deque<bool> sees this specialization.
+
+#ifndef DequeBool_h
+#define DequeBool_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <iterator>  // bidirectional_iterator_tag
+#include <limits>    // numeric_limits
+#include <new>       // bad_alloc
+#include <stdexcept> // invalid_argument
+
+// --------
+// popcount
+// --------
+
+/**
+ * @return the number of bits set in w
+ */
+inline int popcount (unsigned long w) {
+#ifdef __GNUC__
+    return __builtin_popcountl(w);
+#else
+    int n = 0;
+    for (; w != 0; w &= w - 1)
+        ++n;
+    return n;
+#endif
+    }
+
+// --------------------
+// count_trailing_zeros
+// --------------------
+
+/**
+ * @param w a nonzero word
+ * @return the index of the lowest bit set in w
+ */
+inline int count_trailing_zeros (unsigned long w) {
+    assert(w != 0);
+#ifdef __GNUC__
+    return __builtin_ctzl(w);
+#else
+    int n = 0;
+    for (; (w & 1) == 0; w >>= 1)
+        ++n;
+    return n;
+#endif
+    }
+
+// -----------
+// Deque<bool>
+// -----------
+
+/**
+ * A Deque of flags packed 64 to a word.
+ * The words are held in a Deque of unsigned longs, so each of its blocks holds
+ * 640 flags; flag i is bit (_front + i) of the words, read as one long bit
+ * string. Bits outside the flags are kept zero, so count() is a popcount of
+ * every word and find() can test a word at a time.
+ * As with std::vector<bool>, operator [] and iterators yield a proxy reference
+ * rather than a bool&.
+ * capacity_*, try_push_*, memory_footprint and copy-on-write are those of the
+ * Deque of words. splice_* and split_at move whole blocks of words when the seam
+ * falls on a word boundary; otherwise they copy the moved flags one at a time.
+ */
+template <typename A>
+class Deque<bool, A> {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef bool                                     value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef bool                                     const_reference;
+
+        typedef unsigned long                            word_type;
+
+        typedef typename allocator_type::template rebind<word_type>::other word_allocator_type;
+
+        enum {
+            WORD_BITS = std::numeric_limits<word_type>::digits};
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @return true if the two deques store the same flags in the same order, false otherwise
+         */
+        friend bool operator == (const Deque& lhs, const Deque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @return true if the first deque is lexicographically less than the second, false otherwise
+         */
+        friend bool operator < (const Deque& lhs, const Deque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    public:
+        // ---------
+        // reference
+        // ---------
+
+        /**
+         * a proxy for one flag
+         */
+        class reference {
+            friend class Deque;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                word_type* _word;
+                word_type  _mask;
+
+            private:
+                // -----------
+                // constructor
+                // -----------
+
+                reference (word_type* w, word_type m) : _word(w), _mask(m) {}
+
+            public:
+                // Default copy and destructor.
+
+                // -------------
+                // operator bool
+                // -------------
+
+                operator bool () const {
+                    return (*_word & _mask) != 0;}
+
+                // ----------
+                // operator =
+                // ----------
+
+                reference& operator = (bool v) {
+                    if (v)
+                        *_word |= _mask;
+                    else
+                        *_word &= ~_mask;
+                    return *this;}
+
+                /**
+                 * assigns the flag rhs refers to, not rhs itself
+                 */
+                reference& operator = (const reference& rhs) {
+                    return *this = bool(rhs);}
+
+                // ----
+                // flip
+                // ----
+
+                void flip () {
+                    *_word ^= _mask;}};
+
+        typedef void pointer;
+        typedef void const_pointer;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Deque<word_type, word_allocator_type> _words;
+
+        /**
+         * the bit in _words[0] that holds the first flag
+         */
+        size_type _front;
+
+        size_type _size;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_front < size_type(WORD_BITS))
+                && ((_size != 0) || (_front == 0))
+                && (_words.size() == (_front + _size + WORD_BITS - 1) / WORD_BITS);}
+
+        // ---
+        // get
+        // ---
+
+        bool get (size_type index) const {
+            const size_type p = _front + index;
+            return (_words[p / WORD_BITS] >> (p % WORD_BITS)) & 1;}
+
+        // ---
+        // set
+        // ---
+
+        void set (size_type index, bool v) {
+            proxy(*this, index) = v;}
+
+        // -----
+        // proxy
+        // -----
+
+        /**
+         * @return a proxy for the flag at index
+         */
+        static reference proxy (Deque& x, size_type index) {
+            const size_type p = x._front + index;
+            return reference(&x._words[p / WORD_BITS], word_type(1) << (p % WORD_BITS));}
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename Deque::value_type      value_type;
+                typedef typename Deque::difference_type difference_type;
+                typedef typename Deque::pointer         pointer;
+                typedef typename Deque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._deque == rhs._deque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+                friend class Deque;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type _index;
+                Deque*    _deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                iterator (size_type index, Deque* deque) : _index(index), _deque(deque) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return (*_deque)[_index];}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename Deque::value_type      value_type;
+                typedef typename Deque::difference_type difference_type;
+                typedef typename Deque::const_pointer   pointer;
+                typedef typename Deque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._deque == rhs._deque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type    _index;
+                const Deque* _deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                const_iterator (size_type index, const Deque* deque) : _index(index), _deque(deque) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return (*_deque)[_index];}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                const_iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                const_iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                const_iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                const_iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit Deque (const allocator_type& a = allocator_type()) :
+                _words(word_allocator_type(a)),
+                _front(0),
+                _size(0) {
+            assert(valid());}
+
+        /**
+         * @param s the number of flags
+         * @param v the value of each
+         */
+        explicit Deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                _words(word_allocator_type(a)),
+                _front(0),
+                _size(0) {
+            push_back(s, v);
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----------
+        // operator []
+        // -----------
+
+        reference operator [] (size_type index) {
+            return proxy(*this, index);}
+
+        const_reference operator [] (size_type index) const {
+            return get(index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        reference at (size_type index) {
+            if (index >= _size)
+                throw std::invalid_argument("deque::_M_range_check");
+            return (*this)[index];}
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        const_reference at (size_type index) const {
+            if (index >= _size)
+                throw std::invalid_argument("deque::_M_range_check");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        reference back () {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        const_reference back () const {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        iterator begin () {
+            return iterator(0, this);}
+
+        const_iterator begin () const {
+            return const_iterator(0, this);}
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return the number of flags push_back can add before it allocates
+         */
+        size_type capacity_back () const {
+            return _words.capacity_back() * WORD_BITS + (WORD_BITS - (_front + _size) % WORD_BITS) % WORD_BITS;}
+
+        /**
+         * @return the number of flags push_front can add before it allocates
+         */
+        size_type capacity_front () const {
+            return _words.capacity_front() * WORD_BITS + _front;}
+
+        // -----
+        // clear
+        // -----
+
+        void clear () {
+            _words.clear();
+            _front = 0;
+            _size  = 0;
+            assert(valid());}
+
+        // -----
+        // count
+        // -----
+
+        /**
+         * @return the number of flags that are set, counted a word at a time
+         */
+        size_type count () const {
+            size_type n = 0;
+            for (size_type i = 0; i != _words.size(); ++i)
+                n += popcount(_words[i]);
+            return n;}
+
+        // -------------
+        // copy_on_write
+        // -------------
+
+        /**
+         * @return true if copies of this deque share its blocks of words
+         */
+        bool copy_on_write () const {
+            return _words.copy_on_write();}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _size == 0;}
+
+        // ---
+        // end
+        // ---
+
+        iterator end () {
+            return iterator(_size, this);}
+
+        const_iterator end () const {
+            return const_iterator(_size, this);}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * shifts the shorter side of i in by one
+         * @return an iterator to the flag after the one erased
+         */
+        iterator erase (iterator i) {
+            assert(i._index < _size);
+            if (i._index < _size / 2) {
+                for (size_type k = i._index; k != 0; --k)
+                    set(k, get(k - 1));
+                pop_front();}
+            else {
+                for (size_type k = i._index; k + 1 != _size; ++k)
+                    set(k, get(k + 1));
+                pop_back();}
+            return iterator(i._index, this);}
+
+        // ----
+        // find
+        // ----
+
+        /**
+         * @param v    the value to look for
+         * @param from the position to start at
+         * @return the position of the first flag at or after from that equals v, or size() if there is none
+         * tests a word at a time
+         */
+        size_type find (bool v, size_type from = 0) const {
+            if (from >= _size)
+                return _size;
+            const size_type b = _front + from;
+            const size_type e = _front + _size;
+            for (size_type j = b / WORD_BITS; j != _words.size(); ++j) {
+                word_type w = v ? _words[j] : ~_words[j];
+                if (j == b / WORD_BITS)
+                    w &= ~word_type(0) << (b % WORD_BITS);
+                if ((j == (e - 1) / WORD_BITS) && (e % WORD_BITS != 0))
+                    w &= ~(~word_type(0) << (e % WORD_BITS));
+                if (w != 0)
+                    return j * WORD_BITS + count_trailing_zeros(w) - _front;}
+            return _size;}
+
+        // ----------------
+        // find_first_unset
+        // ----------------
+
+        /**
+         * @return the position of the first flag that is not set, or size() if there is none
+         */
+        size_type find_first_unset () const {
+            return find(false);}
+
+        // -----
+        // front
+        // -----
+
+        reference front () {
+            assert(!empty());
+            return (*this)[0];}
+
+        const_reference front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * shifts the shorter side of i out by one
+         * @return an iterator to the inserted flag
+         */
+        iterator insert (iterator i, const_reference v) {
+            assert(i._index <= _size);
+            if (i._index < _size / 2) {
+                push_front(false);
+                for (size_type k = 0; k != i._index; ++k)
+                    set(k, get(k + 1));}
+            else {
+                push_back(false);
+                for (size_type k = _size - 1; k != i._index; --k)
+                    set(k, get(k - 1));}
+            set(i._index, v);
+            return iterator(i._index, this);}
+
+        // ----------------
+        // memory_footprint
+        // ----------------
+
+        /**
+         * @return the bytes held by this deque: the object itself and the footprint of its words
+         */
+        size_type memory_footprint () const {
+            return sizeof(*this) - sizeof(_words) + _words.memory_footprint();}
+
+        // --------
+        // pop_back
+        // --------
+
+        void pop_back () {
+            assert(!empty());
+            set(_size - 1, false);
+            --_size;
+            if (_size == 0)
+                clear();
+            else if ((_front + _size) % WORD_BITS == 0)
+                _words.pop_back();
+            assert(valid());}
+
+        /**
+         * @param n the number of flags to remove from the back, a word at a time where possible
+         */
+        void pop_back (size_type n) {
+            assert(n <= _size);
+            for (; (n != 0) && ((_front + _size) % WORD_BITS != 0); --n)
+                pop_back();
+            for (; n >= size_type(WORD_BITS); n -= WORD_BITS) {
+                _words.pop_back();
+                _size -= WORD_BITS;}
+            for (; n != 0; --n)
+                pop_back();
+            if (_size == 0)
+                clear();
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        void pop_front () {
+            assert(!empty());
+            set(0, false);
+            --_size;
+            if (_size == 0)
+                clear();
+            else if (++_front == size_type(WORD_BITS)) {
+                _words.pop_front();
+                _front = 0;}
+            assert(valid());}
+
+        /**
+         * @param n the number of flags to remove from the front, a word at a time where possible
+         */
+        void pop_front (size_type n) {
+            assert(n <= _size);
+            for (; (n != 0) && (_front != 0); --n)
+                pop_front();
+            for (; n >= size_type(WORD_BITS); n -= WORD_BITS) {
+                _words.pop_front();
+                _size -= WORD_BITS;}
+            for (; n != 0; --n)
+                pop_front();
+            if (_size == 0)
+                clear();
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        void push_back (const_reference v) {
+            if ((_front + _size) % WORD_BITS == 0)
+                _words.push_back(0);
+            ++_size;
+            set(_size - 1, v);
+            assert(valid());}
+
+        /**
+         * @param n the number of flags to add to the back, a word at a time where possible
+         * @param v the value of each
+         */
+        void push_back (size_type n, const_reference v) {
+            for (; (n != 0) && ((_front + _size) % WORD_BITS != 0); --n)
+                push_back(v);
+            for (; n >= size_type(WORD_BITS); n -= WORD_BITS) {
+                _words.push_back(v ? ~word_type(0) : 0);
+                _size += WORD_BITS;}
+            for (; n != 0; --n)
+                push_back(v);
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        void push_front (const_reference v) {
+            if (_front == 0) {
+                _words.push_front(0);
+                _front = WORD_BITS;}
+            --_front;
+            ++_size;
+            set(0, v);
+            assert(valid());}
+
+        /**
+         * @param n the number of flags to add to the front, a word at a time where possible
+         * @param v the value of each
+         */
+        void push_front (size_type n, const_reference v) {
+            for (; (n != 0) && (_front != 0); --n)
+                push_front(v);
+            for (; n >= size_type(WORD_BITS); n -= WORD_BITS) {
+                _words.push_front(v ? ~word_type(0) : 0);
+                _size += WORD_BITS;}
+            for (; n != 0; --n)
+                push_front(v);
+            assert(valid());}
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s the new size
+         * @param v the value of any new flags
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            if (s < _size)
+                pop_back(_size - s);
+            else
+                push_back(s - _size, v);}
+
+        // -----------------
+        // set_copy_on_write
+        // -----------------
+
+        /**
+         * @param b true to share blocks of words with copies, false to stop sharing
+         */
+        void set_copy_on_write (bool b) {
+            _words.set_copy_on_write(b);}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _size;}
+
+        // ------
+        // splice
+        // ------
+
+        /**
+         * @param that the deque whose flags are appended to this deque; it is left empty
+         * when this deque ends and that begins on a word boundary, moves the words of that
+         * with Deque::splice_back, at its cost; otherwise copies the flags of that, in
+         * O(that.size())
+         */
+        void splice_back (Deque& that) {
+            assert(&that != this);
+            if (((_front + _size) % WORD_BITS == 0) && (that._front == 0)) {
+                _words.splice_back(that._words);
+                _size += that._size;}
+            else {
+                const size_type n = _size;
+                try {
+                    for (size_type i = 0; i != that._size; ++i)
+                        push_back(that.get(i));}
+                catch (...) {
+                    pop_back(_size - n);
+                    throw;}}
+            that.clear();
+            assert(valid());}
+
+        /**
+         * @param that the deque whose flags are prepended to this deque; it is left empty
+         * the mirror image of splice_back, with the same costs
+         */
+        void splice_front (Deque& that) {
+            assert(&that != this);
+            if ((_front == 0) && ((that._front + that._size) % WORD_BITS == 0)) {
+                _words.splice_front(that._words);
+                _front  = that._front;
+                _size  += that._size;}
+            else {
+                const size_type n = _size;
+                try {
+                    for (size_type i = that._size; i != 0; --i)
+                        push_front(that.get(i - 1));}
+                catch (...) {
+                    pop_front(_size - n);
+                    throw;}}
+            that.clear();
+            assert(valid());}
+
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * @param i    an iterator into this deque
+         * @param that the deque that receives [i, end()); its previous flags are destroyed
+         * when i falls on a word boundary, moves the words after it with Deque::split_at, at
+         * its cost; otherwise copies the flags of [i, end()), in O(size() - i)
+         */
+        void split_at (iterator i, Deque& that) {
+            assert((i._deque == this) && (&that != this) && (i._index <= _size));
+            that.clear();
+            const size_type p = _front + i._index;
+            if (p % WORD_BITS == 0) {
+                _words.split_at(_words.begin() + p / WORD_BITS, that._words);
+                that._size = _size - i._index;
+                _size      = i._index;
+                if (_size == 0)
+                    _front = 0;}
+            else {
+                try {
+                    for (size_type k = i._index; k != _size; ++k)
+                        that.push_back(get(k));}
+                catch (...) {
+                    that.clear();
+                    throw;}
+                pop_back(_size - i._index);}
+            assert(valid());
+            assert(that.valid());}
+
+        // ----
+        // swap
+        // ----
+
+        void swap (Deque& that) {
+            _words.swap(that._words);
+            std::swap(_front, that._front);
+            std::swap(_size,  that._size);}
+
+        // --------
+        // try_push
+        // --------
+
+        /**
+         * @param v the flag to add
+         * @return true if v was added to the end of this deque, false if the allocator
+         * refused memory for it, in which case the flags of this deque are unchanged
+         */
+        bool try_push_back (const_reference v) {
+            const bool fresh = ((_front + _size) % WORD_BITS == 0);
+            if (fresh && !_words.try_push_back(0))
+                return false;
+            try {
+                set(_size, v);}
+            catch (const std::bad_alloc&) {
+                if (fresh)
+                    _words.pop_back();
+                return false;}
+            ++_size;
+            assert(valid());
+            return true;}
+
+        /**
+         * @param v the flag to add
+         * @return true if v was added to the beginning of this deque, false if the allocator
+         * refused memory for it, in which case the flags of this deque are unchanged
+         */
+        bool try_push_front (const_reference v) {
+            const bool fresh = (_front == 0);
+            if (fresh && !_words.try_push_front(0))
+                return false;
+            const size_type f = fresh ? size_type(WORD_BITS) : _front;
+            try {
+                if (v)
+                    _words.front() |= word_type(1) << (f - 1);}
+            catch (const std::bad_alloc&) {
+                if (fresh)
+                    _words.pop_front();
+                return false;}
+            _front = f - 1;
+            ++_size;
+            assert(valid());
+            return true;}};
+
+#endif // DequeBool_h
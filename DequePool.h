@@ -0,0 +1,420 @@
+// --------------------------
+// projects/deque/DequePool.h
+// --------------------------
+
+#ifndef DequePool_h
+#define DequePool_h
+
+// --------
+// includes
+// --------
+
+#include <cassert> // assert
+#include <memory>  // allocator
+#include <vector>  // vector
+
+#include <stdint.h> // uint16_t, uint32_t
+
+// ---------
+// DequePool
+// ---------
+
+/**
+ * A pool of small deques that share one supply of blocks.
+ * Each deque is a 16-byte handle: the ids of its first and last blocks, its
+ * offsets in them, and its size. Its blocks are linked to each other, so no
+ * deque has an outer array of its own, and an empty deque holds no block at
+ * all. The blocks are carved from slabs of SLAB_SIZE blocks and recycled
+ * through one free list, so a million mostly-empty queues cost a million
+ * handles plus the blocks their elements actually need.
+ * Every operation takes the handle it works on, and once a handle holds
+ * elements it must only be passed to the pool that holds them. The pool
+ * destroys no elements, so each handle must be cleared before the pool is
+ * destroyed.
+ * The pool is not thread-safe.
+ */
+template < typename T, typename A = std::allocator<T> >
+class DequePool {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+
+        enum {
+            BLOCK_SIZE = 8,
+            SLAB_SIZE  = 1024};
+
+    private:
+        /**
+         * BLOCK_SIZE elements and the ids of the blocks before and after them
+         */
+        struct block_type {
+            union {
+                char        _bytes[BLOCK_SIZE * sizeof(T)];
+                long double _align_float;
+                long        _align_integer;
+                void*       _align_pointer;};
+            uint32_t prev;
+            uint32_t next;};
+
+        typedef typename allocator_type::template rebind<block_type>::other block_allocator_type;
+
+        static const uint32_t NIL = 0xFFFFFFFF;
+
+    public:
+        // ------
+        // handle
+        // ------
+
+        /**
+         * a deque in a pool; a default-constructed handle is an empty deque
+         * a copy would share blocks with the original, so handles can't be copied
+         */
+        class handle {
+            friend class DequePool;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                uint32_t _first;
+                uint32_t _last;
+                uint16_t _front;
+                uint16_t _back;
+                uint32_t _size;
+
+            private:
+                // -----
+                // reset
+                // -----
+
+                /**
+                 * makes this handle empty, once its last block has been released
+                 */
+                void reset () {
+                    _first = _last = NIL;
+                    _front = _back = 0;
+                    _size  = 0;}
+
+                handle (const handle&);
+
+                handle& operator = (const handle&);
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                handle () : _first(NIL), _last(NIL), _front(0), _back(0), _size(0) {}
+
+                // Default destructor.
+
+                // -----
+                // empty
+                // -----
+
+                bool empty () const {
+                    return _size == 0;}
+
+                // ----
+                // size
+                // ----
+
+                size_type size () const {
+                    return _size;}};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type _alloc;
+
+        block_allocator_type _block_alloc;
+
+        std::vector<block_type*> _slabs;
+
+        /**
+         * the first block on the free list, linked through next
+         */
+        uint32_t _free;
+
+        /**
+         * the number of blocks carved from the slabs so far
+         */
+        uint32_t _carved;
+
+        /**
+         * the number of blocks held by handles
+         */
+        size_type _used;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_carved <= _slabs.size() * SLAB_SIZE) && (_used <= _carved);}
+
+        static bool valid (const handle& h) {
+            return (h._size == 0) ?
+                ((h._first == NIL) && (h._last == NIL)) :
+                ((h._first != NIL) && (h._last != NIL) && (h._front < BLOCK_SIZE) && (h._back != 0) && (h._back <= BLOCK_SIZE));}
+
+        // -----
+        // block
+        // -----
+
+        block_type& block (uint32_t id) const {
+            return _slabs[id / SLAB_SIZE][id % SLAB_SIZE];}
+
+        // ----
+        // slot
+        // ----
+
+        /**
+         * @return the address of element i of block id
+         */
+        pointer slot (uint32_t id, size_type i) const {
+            return reinterpret_cast<pointer>(block(id)._bytes) + i;}
+
+        // -------
+        // acquire
+        // -------
+
+        /**
+         * @return the id of a block, from the free list or else from the slabs
+         * @throws bad_alloc if a new slab can't be allocated
+         */
+        uint32_t acquire () {
+            uint32_t id = _free;
+            if (id != NIL)
+                _free = block(id).next;
+            else {
+                if (_carved == _slabs.size() * SLAB_SIZE) {
+                    _slabs.push_back(0);
+                    try {
+                        _slabs.back() = _block_alloc.allocate(SLAB_SIZE);}
+                    catch (...) {
+                        _slabs.pop_back();
+                        throw;}}
+                id = _carved++;}
+            block(id).prev = NIL;
+            block(id).next = NIL;
+            ++_used;
+            return id;}
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * @param id a block whose elements have been destroyed
+         */
+        void release (uint32_t id) {
+            block(id).next = _free;
+            _free = id;
+            --_used;}
+
+        DequePool (const DequePool&);
+
+        DequePool& operator = (const DequePool&);
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit DequePool (const allocator_type& a = allocator_type()) :
+                _alloc(a),
+                _block_alloc(a),
+                _free(NIL),
+                _carved(0),
+                _used(0) {
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * frees the slabs; every handle must already be clear
+         */
+        ~DequePool () {
+            assert(_used == 0);
+            for (size_type s = 0; s != _slabs.size(); ++s)
+                _block_alloc.deallocate(_slabs[s], SLAB_SIZE);}
+
+        // ----
+        // back
+        // ----
+
+        reference back (const handle& h) {
+            assert(!h.empty());
+            return *slot(h._last, h._back - 1);}
+
+        const_reference back (const handle& h) const {
+            assert(!h.empty());
+            return *slot(h._last, h._back - 1);}
+
+        // -----------
+        // blocks_used
+        // -----------
+
+        /**
+         * @return the number of blocks held by handles
+         */
+        size_type blocks_used () const {
+            return _used;}
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys the elements of h and returns its blocks to the pool
+         */
+        void clear (handle& h) {
+            while (!h.empty())
+                pop_back(h);}
+
+        // -----
+        // front
+        // -----
+
+        reference front (const handle& h) {
+            assert(!h.empty());
+            return *slot(h._first, h._front);}
+
+        const_reference front (const handle& h) const {
+            assert(!h.empty());
+            return *slot(h._first, h._front);}
+
+        // ----------------
+        // memory_footprint
+        // ----------------
+
+        /**
+         * @return the bytes held by the pool: the object, its slabs, and the list of them
+         */
+        size_type memory_footprint () const {
+            return sizeof(DequePool)
+                + _slabs.size() * SLAB_SIZE * sizeof(block_type)
+                + _slabs.capacity() * sizeof(block_type*);}
+
+        // --------
+        // pop_back
+        // --------
+
+        /**
+         * returns the last block of h to the pool once it is empty
+         */
+        void pop_back (handle& h) {
+            assert(valid(h) && !h.empty());
+            --h._back;
+            _alloc.destroy(slot(h._last, h._back));
+            if (--h._size == 0) {
+                release(h._last);
+                h.reset();}
+            else if (h._back == 0) {
+                const uint32_t id = h._last;
+                h._last = block(id).prev;
+                block(h._last).next = NIL;
+                h._back = BLOCK_SIZE;
+                release(id);}
+            assert(valid(h));}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * returns the first block of h to the pool once it is empty
+         */
+        void pop_front (handle& h) {
+            assert(valid(h) && !h.empty());
+            _alloc.destroy(slot(h._first, h._front));
+            ++h._front;
+            if (--h._size == 0) {
+                release(h._first);
+                h.reset();}
+            else if (h._front == BLOCK_SIZE) {
+                const uint32_t id = h._first;
+                h._first = block(id).next;
+                block(h._first).prev = NIL;
+                h._front = 0;
+                release(id);}
+            assert(valid(h));}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * takes a block from the pool when the last block of h is full
+         * @throws bad_alloc if a new slab can't be allocated
+         */
+        void push_back (handle& h, const_reference v) {
+            assert(valid(h));
+            if (h.empty() || (h._back == BLOCK_SIZE)) {
+                const uint32_t id = acquire();
+                try {
+                    _alloc.construct(slot(id, 0), v);}
+                catch (...) {
+                    release(id);
+                    throw;}
+                if (h.empty()) {
+                    h._first = id;
+                    h._front = 0;}
+                else {
+                    block(id).prev      = h._last;
+                    block(h._last).next = id;}
+                h._last = id;
+                h._back = 1;}
+            else {
+                _alloc.construct(slot(h._last, h._back), v);
+                ++h._back;}
+            ++h._size;
+            assert(valid(h));}
+
+        // ----------
+        // push_front
+        // ----------
+
+        /**
+         * takes a block from the pool when the first block of h is full
+         * @throws bad_alloc if a new slab can't be allocated
+         */
+        void push_front (handle& h, const_reference v) {
+            assert(valid(h));
+            if (h.empty() || (h._front == 0)) {
+                const uint32_t id = acquire();
+                try {
+                    _alloc.construct(slot(id, BLOCK_SIZE - 1), v);}
+                catch (...) {
+                    release(id);
+                    throw;}
+                if (h.empty()) {
+                    h._last = id;
+                    h._back = BLOCK_SIZE;}
+                else {
+                    block(id).next       = h._first;
+                    block(h._first).prev = id;}
+                h._first = id;
+                h._front = BLOCK_SIZE - 1;}
+            else {
+                _alloc.construct(slot(h._first, h._front - 1), v);
+                --h._front;}
+            ++h._size;
+            assert(valid(h));}};
+
+#endif // DequePool_h
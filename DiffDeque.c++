@@ -0,0 +1,465 @@
+// ----------------------------
+// projects/deque/DiffDeque.c++
+// ----------------------------
+
+/*
+To run the differential harness:
+    % g++ -ansi -pedantic -O1 -Wall DiffDeque.c++ -o DiffDeque.c++.app
+    % DiffDeque.c++.app [seed] [steps]
+
+Runs a long random sequence of operations on Deque and std::deque side by side,
+checking that they hold the same values and that every Deque operation stays
+within its performance contract: how many elements it copies, assigns, compares
+and destroys, how many inner and outer arrays it allocates, and how many blocks
+its iterators prefetch.
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // count, fill, min
+#include <cstdlib>   // atol, exit
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+
+#include "Deque.h"
+
+// -------
+// Counted
+// -------
+
+/**
+ * an element that counts what the container does to it
+ */
+struct Counted {
+    static long constructs;
+    static long copies;
+    static long assigns;
+    static long destroys;
+    static long compares;
+    static long prefetches;
+
+    int v;
+
+    Counted (int v = 0) : v(v) {
+        ++constructs;}
+
+    Counted (const Counted& that) : v(that.v) {
+        ++copies;}
+
+    Counted& operator = (const Counted& that) {
+        v = that.v;
+        ++assigns;
+        return *this;}
+
+    ~Counted () {
+        ++destroys;}
+
+    friend bool operator == (const Counted& lhs, const Counted& rhs) {
+        ++compares;
+        return lhs.v == rhs.v;}
+
+    friend bool operator < (const Counted& lhs, const Counted& rhs) {
+        ++compares;
+        return lhs.v < rhs.v;}};
+
+long Counted::constructs = 0;
+long Counted::copies     = 0;
+long Counted::assigns    = 0;
+long Counted::destroys   = 0;
+long Counted::compares   = 0;
+long Counted::prefetches = 0;
+
+// --------
+// prefetch
+// --------
+
+/**
+ * the overload Deque's iterators reach for a block of Counted, so a scan's
+ * prefetches can be counted
+ */
+inline void prefetch (const Counted* p) {
+    ++Counted::prefetches;
+    prefetch(static_cast<const void*>(p));}
+
+// -----------------
+// CountingAllocator
+// -----------------
+
+/**
+ * std::allocator that counts the arrays it hands out, separately for every T
+ */
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    static long allocations;
+    static long live;
+    static long slots;
+
+    template <typename U>
+    struct rebind {
+        typedef CountingAllocator<U> other;};
+
+    CountingAllocator () {}
+
+    template <typename U>
+    CountingAllocator (const CountingAllocator<U>&) {}
+
+    T* allocate (std::size_t n, const void* = 0) {
+        ++allocations;
+        ++live;
+        slots += n;
+        return std::allocator<T>::allocate(n);}
+
+    void deallocate (T* p, std::size_t n) {
+        --live;
+        slots -= n;
+        std::allocator<T>::deallocate(p, n);}
+
+    friend bool operator == (const CountingAllocator&, const CountingAllocator&) {
+        return true;}};
+
+template <typename T>
+long CountingAllocator<T>::allocations = 0;
+
+template <typename T>
+long CountingAllocator<T>::live = 0;
+
+template <typename T>
+long CountingAllocator<T>::slots = 0;
+
+// --------
+// typedefs
+// --------
+
+typedef CountingAllocator<Counted>   Alloc;
+typedef Deque<Counted, Alloc>        D;
+typedef std::deque<int>              S;
+typedef CountingAllocator<Counted*>  OuterAlloc;
+typedef CountingAllocator<D::size_type>     CountAlloc;
+typedef CountingAllocator<D::count_pointer> RefsAlloc;
+
+const long INNER_SIZE = 10;
+
+// ------
+// Random
+// ------
+
+/**
+ * a linear congruential generator, so a seed gives the same run everywhere
+ */
+struct Random {
+    unsigned long state;
+
+    explicit Random (unsigned long seed) : state(seed) {}
+
+    long operator () (long n) {
+        state = (state * 6364136223846793005UL + 1442695040888963407UL) & 0xffffffffffffffffUL;
+        return (long) ((state >> 33) % (unsigned long) n);}};
+
+// --------
+// Snapshot
+// --------
+
+/**
+ * the counters before an operation, so the operation's own costs can be checked
+ */
+struct Snapshot {
+    long copies, assigns, destroys, compares, prefetches, blocks, outers;
+
+    Snapshot () :
+            copies(Counted::copies), assigns(Counted::assigns), destroys(Counted::destroys),
+            compares(Counted::compares), prefetches(Counted::prefetches),
+            blocks(Alloc::allocations), outers(OuterAlloc::allocations) {}
+
+    long copied   () const {return Counted::copies       - copies;}
+    long assigned () const {return Counted::assigns      - assigns;}
+    long destroyed() const {return Counted::destroys     - destroys;}
+    long compared () const {return Counted::compares     - compares;}
+    long fetched  () const {return Counted::prefetches   - prefetches;}
+    long blocked  () const {return Alloc::allocations    - blocks;}
+    long outered  () const {return OuterAlloc::allocations - outers;}};
+
+// -------
+// Harness
+// -------
+
+struct Harness {
+    unsigned long seed;
+    long          step;
+    const char*   op;
+
+    /**
+     * reports a broken check with enough context to replay it, then exits
+     */
+    void check (bool b, const char* what) {
+        if (b)
+            return;
+        std::cout << "FAILED seed " << seed << " step " << step << " " << op << ": " << what << std::endl;
+        std::exit(1);}
+
+    /**
+     * checks that x holds exactly the values of y
+     */
+    void same (const D& x, const S& y) {
+        check(x.size() == y.size(), "size");
+        for (S::size_type i = 0; i != y.size(); ++i)
+            check(x[i].v == y[i], "value");}
+
+    /**
+     * checks that x holds the values of y at the ends and at one random index
+     */
+    void probe (const D& x, const S& y, Random& r) {
+        check(x.size() == y.size(), "size");
+        check(x.empty() == y.empty(), "empty");
+        if (y.empty())
+            return;
+        check(x.front().v == y.front(), "front");
+        check(x.back().v  == y.back(),  "back");
+        const long i = r(y.size());
+        check(x[i].v == y[i], "operator []");}
+
+    /**
+     * runs steps random operations
+     */
+    void run (long steps) {
+        Random r(seed);
+        D a;
+        D b;
+        S sa;
+        S sb;
+        D* snap = 0;
+        S  ssnap;
+        long max_blocks = 1;
+
+        for (step = 0; step != steps; ++step) {
+            const long     n      = sa.size();
+            const bool     cow    = a.copy_on_write();
+            const long     clones = cow ? 2 * INNER_SIZE : 0;
+            const Snapshot s;
+
+            switch (r(17)) {
+                case 0: case 1: case 2: {
+                    op = "push_back";
+                    const Counted v(r(1000));
+                    const Snapshot t;
+                    a.push_back(v);
+                    sa.push_back(v.v);
+                    check(t.copied()   <= 1 + clones, "one copy, none on outer growth");
+                    check(t.assigned() == 0,          "no assignments");
+                    check(t.blocked()  <= 1 + (cow ? 1 : 0), "at most one inner array");
+                    check(t.outered()  <= 1,          "at most one outer array");
+                    break;}
+
+                case 3: case 4: {
+                    op = "push_front";
+                    const Counted v(r(1000));
+                    const Snapshot t;
+                    a.push_front(v);
+                    sa.push_front(v.v);
+                    check(t.copied()   <= 1 + clones, "one copy, none on outer growth");
+                    check(t.assigned() == 0,          "no assignments");
+                    check(t.blocked()  <= 1 + (cow ? 1 : 0), "at most one inner array");
+                    check(t.outered()  <= 1,          "at most one outer array");
+                    break;}
+
+                case 5: case 6: {
+                    op = "pop_back";
+                    if (n == 0)
+                        break;
+                    a.pop_back();
+                    sa.pop_back();
+                    check(s.destroyed() <= 1 + clones, "one destruction");
+                    check(s.assigned()  == 0,          "no assignments");
+                    check(s.blocked()   <= (cow ? 1 : 0), "no allocation");
+                    break;}
+
+                case 7: {
+                    op = "pop_front";
+                    if (n == 0)
+                        break;
+                    a.pop_front();
+                    sa.pop_front();
+                    check(s.destroyed() <= 1 + clones, "one destruction");
+                    check(s.assigned()  == 0,          "no assignments");
+                    check(s.blocked()   <= (cow ? 1 : 0), "no allocation");
+                    break;}
+
+                case 8: {
+                    op = "operator []";
+                    if (n == 0)
+                        break;
+                    const long     i = r(n);
+                    const Counted  v(r(1000));
+                    const Snapshot t;
+                    a[i] = v;
+                    sa[i] = v.v;
+                    check(t.assigned() == 1,      "one assignment");
+                    check(t.copied()   <= clones, "no copies");
+                    break;}
+
+                case 9: {
+                    op = "insert";
+                    const long     i = r(n + 1);
+                    const Counted  v(r(1000));
+                    const Snapshot t;
+                    D::iterator p = a.insert(a.begin() + i, v);
+                    sa.insert(sa.begin() + i, v.v);
+                    check(p == a.begin() + i, "returned iterator");
+                    check(t.assigned() <= std::min(i, n - i) + 1, "assignments bounded by the shorter side");
+                    check(t.copied()   <= 2 + (cow ? std::min(i, n - i) + clones : 0), "at most two copies, plus the inner arrays written if shared");
+                    break;}
+
+                case 10: {
+                    op = "erase";
+                    if (n == 0)
+                        break;
+                    const long i = r(n);
+                    D::iterator p = a.erase(a.begin() + i);
+                    sa.erase(sa.begin() + i);
+                    check(p == a.begin() + i, "returned iterator");
+                    check(s.assigned()  <= std::min(i, n - i - 1) + 1, "assignments bounded by the shorter side");
+                    check(s.destroyed() <= 1 + clones,                 "one destruction");
+                    break;}
+
+                case 11: {
+                    op = "resize";
+                    const long     m = std::max(0L, n + r(2 * INNER_SIZE * 8) - INNER_SIZE * 8);
+                    const Counted  v(r(1000));
+                    const Snapshot t;
+                    a.resize(m, v);
+                    sa.resize(m, v.v);
+                    if (m > n) {
+                        check(t.copied()  <= (m - n) + 1 + clones,           "one copy per new element");
+                        check(t.blocked() <= (m - n) / INNER_SIZE + 1 + (cow ? 1 : 0), "inner arrays allocated once each");
+                        check(t.outered() <= 1,                              "outer array grown at most once");}
+                    else {
+                        check(t.destroyed() <= (n - m) + clones,             "one destruction per dropped element");
+                        check(t.blocked()   <= (cow ? 1 : 0),                "no allocation");}
+                    check(t.assigned() == 0, "no assignments");
+                    break;}
+
+                case 12: {
+                    op = "iterate";
+                    const D&      c = a;
+                    const Counted v(r(1000));
+                    const Snapshot t;
+                    const long k = std::count(c.begin(), c.end(), v);
+                    check(k == std::count(sa.begin(), sa.end(), v.v), "count");
+                    check(t.fetched()  <= n / INNER_SIZE + 1, "one prefetch per block, not per step");
+                    check(t.blocked()  == 0, "a const scan allocates nothing");
+                    check(t.copied()   == 0, "no copies");
+                    const Snapshot u;
+                    std::fill(a.begin(), a.end(), v);
+                    std::fill(sa.begin(), sa.end(), v.v);
+                    check(u.fetched()  <= n / INNER_SIZE + 1,        "one prefetch per block, not per step");
+                    check(u.blocked()  <= (cow ? n / INNER_SIZE + 2 : 0), "a scan allocates only to unshare");
+                    check(u.copied()   <= clones * (n / INNER_SIZE + 2), "no copies");
+                    break;}
+
+                case 13: {
+                    op = "copy";
+                    const Snapshot t;
+                    D c(a);
+                    if (cow)
+                        check(t.copied() == 0, "copy-on-write copies no elements");
+                    else {
+                        check(t.copied()  == n,                  "one copy per element");
+                        check(t.blocked() <= n / INNER_SIZE + 1, "one allocation per inner array");}
+                    check(t.outered() <= 1, "one outer array");
+                    same(c, sa);
+                    if (r(4) == 0) {
+                        delete snap;
+                        snap  = new D(a);
+                        ssnap = sa;}
+                    break;}
+
+                case 14: {
+                    op = "splice";
+                    const long m = r(3 * INNER_SIZE);
+                    for (long i = 0; i != m; ++i) {
+                        b.push_back(Counted(i));
+                        sb.push_back(i);}
+                    const long     k      = sb.size();
+                    const bool     shared = (snap != 0) && (cow || b.copy_on_write());
+                    const Snapshot t;
+                    if (r(2)) {
+                        a.splice_back(b);
+                        sa.insert(sa.end(), sb.begin(), sb.end());}
+                    else {
+                        a.splice_front(b);
+                        sa.insert(sa.begin(), sb.begin(), sb.end());}
+                    sb.clear();
+                    check(b.empty(), "emptied");
+                    check(t.copied() <= (cow ? 2 : 1) * std::min(n, k) + INNER_SIZE + clones, "copies bounded by the smaller side");
+                    check(t.blocked() <= 1 + (shared ? std::min(n, k) / INNER_SIZE + 4 : 0), "a misaligned seam allocates at most one inner array");
+                    break;}
+
+                case 15: {
+                    op = "split_at";
+                    if (r(8) == 0) {
+                        a.set_copy_on_write(!cow);
+                        break;}
+                    const long     i = r(n + 1);
+                    b.set_copy_on_write(cow);
+                    const Snapshot t;
+                    a.split_at(a.begin() + i, b);
+                    sb.assign(sa.begin() + i, sa.end());
+                    sa.erase(sa.begin() + i, sa.end());
+                    check(t.copied()  <= INNER_SIZE + clones, "copies only the split inner array");
+                    check(t.blocked() <= 1 + (cow ? 2 : 0),   "one inner array");
+                    same(b, sb);
+                    b.clear();
+                    sb.clear();
+                    break;}
+
+                case 16: {
+                    op = "queue";
+                    if (n == 0)
+                        break;
+                    Snapshot t;
+                    for (long i = 0; i != 100 * INNER_SIZE; ++i) {
+                        if (i == 50 * INNER_SIZE)
+                            t = Snapshot();
+                        a.push_back(Counted(i));
+                        a.pop_front();
+                        sa.push_back(i);
+                        sa.pop_front();}
+                    check(t.outered() == 0, "a queue of steady size stops growing its outer array");
+                    break;}}
+
+            max_blocks = std::max(max_blocks, (long) (sa.size() / INNER_SIZE + 2));
+            check(OuterAlloc::slots <= 12 * max_blocks + 64, "outer arrays stay proportional to the inner arrays in use");
+            probe(a, sa, r);
+            if (step % 64 == 0) {
+                same(a, sa);
+                if (snap)
+                    same(*snap, ssnap);}}
+
+        op = "end";
+        same(a, sa);
+        delete snap;}};
+
+// ----
+// main
+// ----
+
+int main (int argc, char* argv[]) {
+    using namespace std;
+    cout << "DiffDeque.c++" << endl;
+
+    Harness h;
+    h.seed = (argc > 1) ? atol(argv[1]) : 20100803;
+    const long steps = (argc > 2) ? atol(argv[2]) : 200000;
+    h.run(steps);
+
+    h.step = steps;
+    h.op   = "leaks";
+    h.check(Counted::constructs + Counted::copies == Counted::destroys, "every element destroyed");
+    h.check(Alloc::live == 0 && OuterAlloc::live == 0,                  "every array freed");
+    h.check(CountAlloc::live == 0 && RefsAlloc::live == 0,              "every reference count freed");
+
+    cout << "seed " << h.seed << ", " << steps << " steps" << endl;
+    cout << "Done." << endl;
+    return 0;}
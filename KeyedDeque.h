@@ -0,0 +1,520 @@
+// ---------------------------
+// projects/deque/KeyedDeque.h
+// ---------------------------
+
+#ifndef KeyedDeque_h
+#define KeyedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // invalid_argument
+
+#include "Deque.h"
+
+// ----------
+// KeyedDeque
+// ----------
+
+/**
+ * A deque whose elements are kept in nondecreasing order of a key, such as
+ * events by timestamp.
+ * KeyOf is a unary function that returns the key of an element; its
+ * result_type is the key_type. Elements live in blocks of BLOCK_SIZE, and
+ * beside the outer array of block pointers is an array of the first key of
+ * each block. lower_bound and upper_bound binary-search the block keys and
+ * then one block, so a range query is O(log n). evict_before drops whole
+ * blocks from the front, so it costs the blocks it evicts, not the elements.
+ * Elements are appended with push_back, whose key must be no less than the
+ * key of back(), and removed from either end.
+ */
+template < typename T, typename KeyOf, typename A = std::allocator<T> >
+class KeyedDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::const_reference const_reference;
+
+        typedef typename KeyOf::result_type key_type;
+
+        enum {
+            BLOCK_SIZE = 256};
+
+    private:
+        /**
+         * an entry of the outer array: a block of BLOCK_SIZE elements and the key of its first element
+         */
+        struct entry_type {
+            key_type key;
+            pointer  block;};
+
+        typedef typename allocator_type::template rebind<entry_type>::other entry_allocator_type;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        friend bool operator == (const KeyedDeque& lhs, const KeyedDeque& rhs) {
+            return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        friend bool operator < (const KeyedDeque& lhs, const KeyedDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag      iterator_category;
+                typedef typename KeyedDeque::value_type      value_type;
+                typedef typename KeyedDeque::difference_type difference_type;
+                typedef const value_type*                    pointer;
+                typedef const value_type&                    reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return (lhs._index == rhs._index) && (lhs._deque == rhs._deque);}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type         _index;
+                const KeyedDeque* _deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                const_iterator (size_type index, const KeyedDeque* deque) : _index(index), _deque(deque) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return (*_deque)[_index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                const_iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                const_iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                const_iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                const_iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type _alloc;
+
+        KeyOf _key;
+
+        /**
+         * the outer array, with the first key of each block beside its pointer
+         */
+        Deque<entry_type, entry_allocator_type> _blocks;
+
+        /**
+         * the offset of the first element in the first block
+         */
+        size_type _front;
+
+        size_type _size;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_front < size_type(BLOCK_SIZE))
+                && (_blocks.empty() == (_size == 0))
+                && (_blocks.empty() ? (_front == 0) : (_front + _size > (_blocks.size() - 1) * BLOCK_SIZE))
+                && (_front + _size <= _blocks.size() * BLOCK_SIZE);}
+
+        // ----
+        // slot
+        // ----
+
+        /**
+         * @param index a position in this deque
+         * @return the address of its element
+         */
+        pointer slot (size_type index) const {
+            const size_type i = _front + index;
+            return _blocks[i / BLOCK_SIZE].block + i % BLOCK_SIZE;}
+
+        // ---------
+        // drop_back
+        // ---------
+
+        /**
+         * frees the last block, whose elements have been destroyed
+         */
+        void drop_back () {
+            _alloc.deallocate(_blocks.back().block, BLOCK_SIZE);
+            _blocks.pop_back();
+            if (_blocks.empty())
+                _front = 0;}
+
+        // ----------
+        // drop_front
+        // ----------
+
+        /**
+         * frees the first block, whose elements have been destroyed
+         */
+        void drop_front () {
+            _alloc.deallocate(_blocks.front().block, BLOCK_SIZE);
+            _blocks.pop_front();
+            _front = 0;}
+
+        // ------
+        // search
+        // ------
+
+        /**
+         * @param k     a key
+         * @param upper false to find the first element whose key isn't less than k,
+         *              true to find the first element whose key is greater than k
+         * @return its index, or size() if there is none
+         */
+        size_type search (const key_type& k, bool upper) const {
+            size_type lo = 0;
+            size_type hi = _blocks.size();
+            while (lo != hi) {
+                const size_type mid = lo + (hi - lo) / 2;
+                if (upper ? !(k < _blocks[mid].key) : (_blocks[mid].key < k))
+                    lo = mid + 1;
+                else
+                    hi = mid;}
+            if (lo == 0)
+                return 0;
+            const pointer   b = _blocks[lo - 1].block;
+            size_type       f = (lo == 1) ? _front : 0;
+            size_type       l = std::min<size_type>(BLOCK_SIZE, _front + _size - (lo - 1) * BLOCK_SIZE);
+            while (f != l) {
+                const size_type mid = f + (l - f) / 2;
+                if (upper ? !(k < _key(b[mid])) : (_key(b[mid]) < k))
+                    f = mid + 1;
+                else
+                    l = mid;}
+            return (lo - 1) * BLOCK_SIZE + f - _front;}
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit KeyedDeque (const KeyOf& key = KeyOf(), const allocator_type& a = allocator_type()) :
+                _alloc(a),
+                _key(key),
+                _blocks(entry_allocator_type(a)),
+                _front(0),
+                _size(0) {
+            assert(valid());}
+
+        KeyedDeque (const KeyedDeque& that) :
+                _alloc(that._alloc),
+                _key(that._key),
+                _blocks(entry_allocator_type(that._alloc)),
+                _front(0),
+                _size(0) {
+            try {
+                for (size_type i = 0; i != that.size(); ++i)
+                    push_back(that[i]);}
+            catch (...) {
+                clear();
+                throw;}
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~KeyedDeque () {
+            clear();}
+
+        // ----------
+        // operator =
+        // ----------
+
+        KeyedDeque& operator = (const KeyedDeque& rhs) {
+            KeyedDeque that(rhs);
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        const_reference operator [] (size_type index) const {
+            assert(index < size());
+            return *slot(index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        const_reference at (size_type index) const {
+            if (index >= size())
+                throw std::invalid_argument("KeyedDeque::at index out of range");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        const_reference back () const {
+            assert(!empty());
+            return (*this)[size() - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        const_iterator begin () const {
+            return const_iterator(0, this);}
+
+        // -----
+        // clear
+        // -----
+
+        void clear () {
+            evict_before_index(size());}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return size() == 0;}
+
+        // ---
+        // end
+        // ---
+
+        const_iterator end () const {
+            return const_iterator(size(), this);}
+
+        // ------------
+        // evict_before
+        // ------------
+
+        /**
+         * removes every element whose key is less than k
+         * @return the number removed
+         */
+        size_type evict_before (const key_type& k) {
+            const size_type n = lower_bound(k);
+            evict_before_index(n);
+            return n;}
+
+        // ------------------
+        // evict_before_index
+        // ------------------
+
+        /**
+         * removes the first n elements, freeing the blocks they leave empty
+         */
+        void evict_before_index (size_type n) {
+            assert(n <= size());
+            while ((n != 0) && (_front + n >= size_type(BLOCK_SIZE))) {
+                const size_type m = std::min<size_type>(BLOCK_SIZE - _front, _size);
+                const pointer   b = _blocks.front().block;
+                for (size_type i = _front; i != _front + m; ++i)
+                    _alloc.destroy(b + i);
+                n     -= m;
+                _size -= m;
+                drop_front();}
+            while (n != 0) {
+                pop_front();
+                --n;}
+            assert(valid());}
+
+        // -----
+        // front
+        // -----
+
+        const_reference front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // -----------
+        // lower_bound
+        // -----------
+
+        /**
+         * @return the index of the first element whose key isn't less than k, or size() if there is none
+         */
+        size_type lower_bound (const key_type& k) const {
+            return search(k, false);}
+
+        // --------
+        // pop_back
+        // --------
+
+        /**
+         * frees the last block once it is empty, so no block keeps the key of a removed element
+         */
+        void pop_back () {
+            assert(!empty());
+            --_size;
+            const size_type i = _front + _size;
+            _alloc.destroy(_blocks.back().block + i % BLOCK_SIZE);
+            if ((i % BLOCK_SIZE == 0) || (_size == 0))
+                drop_back();
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * keeps the key of the first block equal to the key of front()
+         */
+        void pop_front () {
+            assert(!empty());
+            _alloc.destroy(_blocks.front().block + _front);
+            ++_front;
+            --_size;
+            if ((_front == size_type(BLOCK_SIZE)) || (_size == 0))
+                drop_front();
+            else
+                _blocks.front().key = _key(_blocks.front().block[_front]);
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v an element whose key is no less than the key of back()
+         */
+        void push_back (const_reference v) {
+            assert(empty() || !(_key(v) < _key(back())));
+            const size_type i = _front + _size;
+            if (i == _blocks.size() * BLOCK_SIZE) {
+                const entry_type e = {_key(v), _alloc.allocate(BLOCK_SIZE)};
+                try {
+                    _alloc.construct(e.block, v);
+                    try {
+                        _blocks.push_back(e);}
+                    catch (...) {
+                        _alloc.destroy(e.block);
+                        throw;}}
+                catch (...) {
+                    _alloc.deallocate(e.block, BLOCK_SIZE);
+                    throw;}}
+            else
+                _alloc.construct(_blocks.back().block + i % BLOCK_SIZE, v);
+            ++_size;
+            assert(valid());}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _size;}
+
+        // ----
+        // swap
+        // ----
+
+        void swap (KeyedDeque& that) {
+            std::swap(_alloc, that._alloc);
+            std::swap(_key,   that._key);
+            _blocks.swap(that._blocks);
+            std::swap(_front, that._front);
+            std::swap(_size,  that._size);}
+
+        // -----------
+        // upper_bound
+        // -----------
+
+        /**
+         * @return the index of the first element whose key is greater than k, or size() if there is none
+         */
+        size_type upper_bound (const key_type& k) const {
+            return search(k, true);}};
+
+#endif // KeyedDeque_h
@@ -0,0 +1,257 @@
+// -----------------------------
+// projects/deque/MemoryBudget.h
+// -----------------------------
+
+#ifndef MemoryBudget_h
+#define MemoryBudget_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef> // ptrdiff_t, size_t
+#include <new>     // bad_alloc, new, operator delete, operator new
+
+// --------------
+// BudgetExceeded
+// --------------
+
+/**
+ * thrown by BudgetAllocator when an allocation would take its MemoryBudget over the limit
+ */
+class BudgetExceeded : public std::bad_alloc {
+    public:
+        const char* what () const throw () {
+            return "memory budget exceeded";}};
+
+// ------------
+// MemoryBudget
+// ------------
+
+/**
+ * A limit on the bytes that a group of containers may hold at once.
+ * Each allocation is charged against the budget before it is made and each
+ * deallocation releases its charge, so used() is the bytes the group holds
+ * now. A charge that would pass the limit fails without allocating anything.
+ * Charges are made with an atomic compare-and-swap, so deques on different
+ * threads can share one budget.
+ */
+class MemoryBudget {
+    private:
+        // ----
+        // data
+        // ----
+
+        const std::size_t _limit;
+
+        std::size_t _used;
+
+        MemoryBudget (const MemoryBudget&);
+
+        MemoryBudget& operator = (const MemoryBudget&);
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param limit the most bytes the group may hold at once
+         */
+        explicit MemoryBudget (std::size_t limit) : _limit(limit), _used(0) {}
+
+        // ------
+        // charge
+        // ------
+
+        /**
+         * @param bytes the size of an allocation about to be made
+         * @return true if it fits and has been charged, false otherwise
+         */
+        bool charge (std::size_t bytes) {
+            std::size_t u = used();
+            for (;;) {
+                if (bytes > _limit - u)
+                    return false;
+                const std::size_t v = __sync_val_compare_and_swap(&_used, u, u + bytes);
+                if (v == u)
+                    return true;
+                u = v;}}
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * @param bytes the size of an allocation that has been freed
+         */
+        void release (std::size_t bytes) {
+            __sync_sub_and_fetch(&_used, bytes);}
+
+        // ---------
+        // available
+        // ---------
+
+        /**
+         * @return the bytes that can still be charged
+         */
+        std::size_t available () const {
+            return _limit - used();}
+
+        // -----
+        // limit
+        // -----
+
+        std::size_t limit () const {
+            return _limit;}
+
+        // ----
+        // used
+        // ----
+
+        std::size_t used () const {
+            return __sync_add_and_fetch(const_cast<std::size_t*>(&_used), 0);}};
+
+// ---------------
+// BudgetAllocator
+// ---------------
+
+/**
+ * An allocator that charges a MemoryBudget for every allocation, for use as
+ * Deque's A, so that the outer array and every inner array of the deques that
+ * share it count against one limit. An allocation past the limit throws
+ * BudgetExceeded; Deque's try_push_back and try_push_front check can_allocate
+ * first, so they refuse a push the budget can't cover without throwing.
+ * A default-constructed BudgetAllocator has no budget and never refuses;
+ * two BudgetAllocators compare equal if they charge the same budget.
+ */
+template <typename T>
+class BudgetAllocator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+
+        template <typename U>
+        struct rebind {
+            typedef BudgetAllocator<U> other;};
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        friend bool operator == (const BudgetAllocator& lhs, const BudgetAllocator& rhs) {
+            return lhs._budget == rhs._budget;}
+
+    private:
+        // ----
+        // data
+        // ----
+
+        MemoryBudget* _budget;
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        BudgetAllocator () : _budget(0) {}
+
+        explicit BudgetAllocator (MemoryBudget& b) : _budget(&b) {}
+
+        template <typename U>
+        BudgetAllocator (const BudgetAllocator<U>& that) : _budget(that.budget()) {}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -------
+        // address
+        // -------
+
+        pointer address (reference x) const {
+            return &x;}
+
+        const_pointer address (const_reference x) const {
+            return &x;}
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param n the number of elements
+         * @return uninitialized space for n elements
+         * @throws BudgetExceeded if the budget can't cover them, bad_alloc if the system is out of memory
+         */
+        pointer allocate (size_type n, const void* = 0) {
+            const size_type bytes = n * sizeof(T);
+            if ((_budget != 0) && !_budget->charge(bytes))
+                throw BudgetExceeded();
+            try {
+                return static_cast<pointer>(::operator new(bytes));}
+            catch (...) {
+                if (_budget != 0)
+                    _budget->release(bytes);
+                throw;}}
+
+        // ------
+        // budget
+        // ------
+
+        /**
+         * @return the budget this allocator charges, or 0 if it has none
+         */
+        MemoryBudget* budget () const {
+            return _budget;}
+
+        // ---------
+        // construct
+        // ---------
+
+        void construct (pointer p, const_reference v) {
+            new (p) T(v);}
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (pointer p, size_type n) {
+            if (_budget != 0)
+                _budget->release(n * sizeof(T));
+            ::operator delete(p);}
+
+        // -------
+        // destroy
+        // -------
+
+        void destroy (pointer p) {
+            p->~T();}
+
+        // --------
+        // max_size
+        // --------
+
+        size_type max_size () const {
+            return size_type(-1) / sizeof(T);}};
+
+// ------------
+// can_allocate
+// ------------
+
+/**
+ * @return false if the budget of a can't cover an allocation of bytes
+ */
+template <typename T>
+bool can_allocate (const BudgetAllocator<T>& a, std::size_t bytes) {
+    return (a.budget() == 0) || (bytes <= a.budget()->available());}
+
+#endif // MemoryBudget_h
@@ -0,0 +1,140 @@
+// -------------------------------
+// projects/deque/MonotonicDeque.h
+// -------------------------------
+
+#ifndef MonotonicDeque_h
+#define MonotonicDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>    // assert
+#include <functional> // less
+#include <memory>     // allocator
+#include <utility>    // pair
+
+#include "Deque.h"
+
+// --------------
+// MonotonicDeque
+// --------------
+
+/**
+ * A sliding window that answers its extreme element in O(1).
+ * Values enter at the back and leave from the front, in order. Only the values
+ * that can still become the extreme are kept: a new value evicts every value
+ * before it that it beats, so the kept values are monotonic and the front one
+ * is the extreme. Every value is pushed and popped at most once, so push_back
+ * and pop_front are amortized O(1).
+ * With Compare = std::less<T> front() is the minimum, with std::greater<T> the maximum.
+ */
+template < typename T, typename C = std::less<T>, typename A = std::allocator<T> >
+class MonotonicDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T                                      value_type;
+        typedef C                                      value_compare;
+        typedef typename A::size_type                  size_type;
+        typedef const T&                               const_reference;
+
+        typedef std::pair<T, size_type>                entry_type;
+        typedef typename classic_allocator<A>::type::template rebind<entry_type>::other entry_allocator_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Deque<entry_type, entry_allocator_type> _kept;
+
+        value_compare _compare;
+
+        size_type _head, _tail;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return _head <= _tail
+                && (_kept.empty() || (_head <= _kept.front().second && _kept.back().second < _tail));}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param c the comparison whose least element front() returns
+         */
+        explicit MonotonicDeque (const value_compare& c = value_compare()) : _compare(c), _head(0), _tail(0) {
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return the extreme value in the window
+         */
+        const_reference front () const {
+            assert(!empty());
+            return _kept.front().first;}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * removes the oldest value from the window
+         */
+        void pop_front () {
+            assert(!empty());
+            if (_kept.front().second == _head)
+                _kept.pop_front();
+            ++_head;
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v the value to add to the window
+         * drops every kept value that v beats or equals, since none can be the extreme while v is in the window
+         */
+        void push_back (const_reference v) {
+            while (!_kept.empty() && !_compare(_kept.back().first, v))
+                _kept.pop_back();
+            _kept.push_back(entry_type(v, _tail));
+            ++_tail;
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return true if the window is empty
+         */
+        bool empty () const {
+            return _head == _tail;}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of values in the window, kept or not
+         */
+        size_type size () const {
+            return _tail - _head;}};
+
+#endif // MonotonicDeque_h
@@ -0,0 +1,324 @@
+// ---------------------------
+// projects/deque/SpillDeque.h
+// ---------------------------
+
+#ifndef SpillDeque_h
+#define SpillDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>   // assert
+#include <cstdio>    // fclose, fileno, FILE, fread, fseek, fwrite, setvbuf, tmpfile
+#include <cstring>   // memcpy
+#include <memory>    // allocator
+#include <stdexcept> // runtime_error
+#include <vector>    // vector
+
+#include <fcntl.h>  // posix_fadvise
+#include <unistd.h> // ftruncate
+
+#include "Deque.h"
+
+// ----------
+// SpillDeque
+// ----------
+
+/**
+ * A FIFO queue that keeps at most a budget of blocks in memory and spills the
+ * rest to a temporary file.
+ * The values are held in three parts: a hot head, which pop_front drains, a
+ * hot tail, which push_back fills, and between them a run of BLOCK_SIZE-value
+ * blocks on disk. When the values in memory pass the budget, the oldest block
+ * of the tail is appended to the file; when the head falls below a block, the
+ * next block is read back and the kernel is told to read the blocks after it
+ * ahead. The file is written and read sequentially, and is truncated whenever
+ * the queue catches up with it.
+ * The values are copied to disk byte for byte, so T must be a POD type, one
+ * that is trivially copyable and holds no pointers into memory; under g++ a T
+ * that isn't POD fails to compile.
+ * A SpillDeque owns its file, so it can't be copied.
+ */
+template < typename T, typename A = std::allocator<T> >
+class SpillDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+
+        enum {
+            BLOCK_SIZE = 1024,
+            READ_AHEAD = 4};
+
+    private:
+#ifdef __GNUC__
+        typedef char t_is_a_pod[__is_pod(T) ? 1 : -1];
+#endif
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Deque<value_type, allocator_type> _head;
+
+        Deque<value_type, allocator_type> _tail;
+
+        /**
+         * the most values to keep in memory before spilling, in blocks
+         */
+        size_type _budget;
+
+        /**
+         * the number of blocks in the file, between _head and _tail
+         */
+        size_type _spilled;
+
+        std::FILE* _file;
+
+        long _read_at;
+
+        long _write_at;
+
+        std::vector<char> _buffer;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_budget >= 2)
+                && (!_head.empty() || ((_spilled == 0) && _tail.empty()))
+                && ((_spilled == 0) || !_tail.empty())
+                && ((_spilled == 0) || (_file != 0))
+                && (_write_at - _read_at == long(_spilled * BLOCK_SIZE * sizeof(value_type)));}
+
+        // -----
+        // spill
+        // -----
+
+        /**
+         * appends the oldest block of the tail to the file
+         * @throws runtime_error if the file can't be created or written
+         */
+        void spill () {
+            const size_type bytes = BLOCK_SIZE * sizeof(value_type);
+            if (_file == 0) {
+                _file = std::tmpfile();
+                if (_file == 0)
+                    throw std::runtime_error("SpillDeque can't create its file");
+                std::setvbuf(_file, 0, _IONBF, 0);
+                _buffer.resize(bytes);}
+            for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k)
+                std::memcpy(&_buffer[k * sizeof(value_type)], &_tail[k], sizeof(value_type));
+            if ((std::fseek(_file, _write_at, SEEK_SET) != 0) || (std::fwrite(&_buffer[0], 1, bytes, _file) != bytes))
+                throw std::runtime_error("SpillDeque can't write its file");
+            _write_at += bytes;
+            ++_spilled;
+            for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k)
+                _tail.pop_front();}
+
+        // ----
+        // load
+        // ----
+
+        /**
+         * reads the next block of the file onto the end of the head
+         * @throws runtime_error if the file can't be read
+         */
+        void load () {
+            const size_type bytes = BLOCK_SIZE * sizeof(value_type);
+            if ((std::fseek(_file, _read_at, SEEK_SET) != 0) || (std::fread(&_buffer[0], 1, bytes, _file) != bytes))
+                throw std::runtime_error("SpillDeque can't read its file");
+            const size_type s = _head.size();
+            try {
+                for (size_type k = 0; k != size_type(BLOCK_SIZE); ++k) {
+                    value_type v;
+                    std::memcpy(&v, &_buffer[k * sizeof(value_type)], sizeof(value_type));
+                    _head.push_back(v);}}
+            catch (...) {
+                while (_head.size() != s)
+                    _head.pop_back();
+                throw;}
+            _read_at += bytes;
+            --_spilled;
+            if (_spilled != 0)
+                read_ahead();
+            else if (ftruncate(fileno(_file), 0) == 0) {
+                _read_at  = 0;
+                _write_at = 0;}}
+
+        // ----------
+        // read_ahead
+        // ----------
+
+        /**
+         * asks the kernel to start reading the next READ_AHEAD blocks of the file
+         */
+        void read_ahead () const {
+#ifdef POSIX_FADV_WILLNEED
+            posix_fadvise(fileno(_file), _read_at, READ_AHEAD * BLOCK_SIZE * sizeof(value_type), POSIX_FADV_WILLNEED);
+#endif
+            }
+
+        // ----
+        // shed
+        // ----
+
+        /**
+         * spills the oldest blocks of the tail while more than the budget is in memory
+         */
+        void shed () {
+            while ((resident() > _budget * BLOCK_SIZE) && (_tail.size() > size_type(BLOCK_SIZE)))
+                spill();}
+
+        SpillDeque (const SpillDeque&);
+
+        SpillDeque& operator = (const SpillDeque&);
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param budget the most blocks of BLOCK_SIZE values to keep in memory, at least 2
+         */
+        explicit SpillDeque (size_type budget, const allocator_type& a = allocator_type()) :
+                _head(a),
+                _tail(a),
+                _budget(budget),
+                _spilled(0),
+                _file(0),
+                _read_at(0),
+                _write_at(0) {
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~SpillDeque () {
+            if (_file != 0)
+                std::fclose(_file);}
+
+        // ----
+        // back
+        // ----
+
+        reference back () {
+            assert(!empty());
+            return _tail.empty() ? _head.back() : _tail.back();}
+
+        const_reference back () const {
+            return const_cast<SpillDeque*>(this)->back();}
+
+        // ------
+        // budget
+        // ------
+
+        size_type budget () const {
+            return _budget;}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _head.empty();}
+
+        // -----
+        // front
+        // -----
+
+        reference front () {
+            assert(!empty());
+            return _head.front();}
+
+        const_reference front () const {
+            return const_cast<SpillDeque*>(this)->front();}
+
+        // ----------------
+        // memory_footprint
+        // ----------------
+
+        /**
+         * @return the bytes held in memory by this deque: the object itself, the
+         * footprints of its head and tail, and its transfer buffer, but not its file
+         */
+        size_type memory_footprint () const {
+            return sizeof(*this) - sizeof(_head) - sizeof(_tail)
+                + _head.memory_footprint() + _tail.memory_footprint() + _buffer.capacity();}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * reads the next block back once the head holds less than one, and
+         * spills the tail to make room for it
+         * @throws runtime_error if the file can't be read or written
+         */
+        void pop_front () {
+            assert(!empty());
+            _head.pop_front();
+            if ((_spilled != 0) && (_head.size() < size_type(BLOCK_SIZE))) {
+                load();
+                shed();}
+            else if (_head.empty())
+                _head.swap(_tail);
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * spills the oldest block of the tail once more than the budget is in memory
+         * @throws runtime_error if the file can't be created or written
+         */
+        void push_back (const_reference v) {
+            if (_head.empty())
+                _head.push_back(v);
+            else {
+                _tail.push_back(v);
+                shed();}
+            assert(valid());}
+
+        // --------
+        // resident
+        // --------
+
+        /**
+         * @return the number of values in memory, at most (budget() + 1) * BLOCK_SIZE
+         */
+        size_type resident () const {
+            return _head.size() + _tail.size();}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return resident() + _spilled * BLOCK_SIZE;}
+
+        // -------
+        // spilled
+        // -------
+
+        /**
+         * @return the number of blocks on disk
+         */
+        size_type spilled () const {
+            return _spilled;}};
+
+#endif // SpillDeque_h
@@ -0,0 +1,688 @@
+// ----------------------------
+// projects/deque/StaticDeque.h
+// ----------------------------
+
+#ifndef StaticDeque_h
+#define StaticDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <cstddef>   // ptrdiff_t, size_t
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // construct_at, destroy_at
+#include <new>       // new
+#include <stdexcept> // invalid_argument
+#include <utility>   // !=, <=, >, >=
+
+// ----------------------
+// STATIC_DEQUE_CONSTEXPR
+// ----------------------
+
+// constexpr as C++20, where construct_at and destroy_at let a constant
+// expression build and tear down elements in place; nothing as C++98
+
+#if __cplusplus >= 202002L
+    #define STATIC_DEQUE_CONSTEXPR constexpr
+#else
+    #define STATIC_DEQUE_CONSTEXPR
+#endif
+
+// -----------
+// StaticDeque
+// -----------
+
+/**
+ * A deque of at most N elements that never allocates.
+ * The elements live in an inline circular array; N must be a power of two so
+ * that a position wraps with a mask instead of a division. The interface is
+ * Deque's, except that growing past N is a precondition violation, checked by
+ * assert, rather than an allocation.
+ * As C++20 the constructor, destructor, pushes, pops, indexing, and size are
+ * constexpr, so a StaticDeque can be used inside a constant expression.
+ */
+template <typename T, std::size_t N>
+class StaticDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+
+        typedef T&             reference;
+        typedef const T&       const_reference;
+
+    private:
+        typedef char n_is_a_power_of_two[((N != 0) && ((N & (N - 1)) == 0)) ? 1 : -1];
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @return true if the two deques store the same values in the same order, false otherwise
+         */
+        friend bool operator == (const StaticDeque& lhs, const StaticDeque& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @return true if the first deque is lexicographically less than the second, false otherwise
+         */
+        friend bool operator < (const StaticDeque& lhs, const StaticDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        // ----
+        // data
+        // ----
+
+#if __cplusplus >= 202002L
+        /**
+         * one slot of the circular array, a union so that its element's
+         * lifetime is under this deque's control, even in a constant expression
+         */
+        union cell {
+            T _value;
+
+            constexpr cell () {}
+
+            constexpr ~cell () {}};
+
+        cell _cells[N];
+#else
+        /**
+         * raw storage for N elements, aligned for any fundamental type
+         */
+        union {
+            char        _bytes[N * sizeof(T)];
+            long double _align_float;
+            long        _align_integer;
+            void*       _align_pointer;};
+#endif
+
+        size_type _head;
+
+        size_type _size;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR bool valid () const {
+            return (_head < N) && (_size <= N);}
+
+        // ----
+        // slot
+        // ----
+
+        /**
+         * @param index a position in this deque, possibly one past the end
+         * @return the address of its slot in the circular array
+         */
+#if __cplusplus >= 202002L
+        constexpr pointer slot (size_type index) {
+            return &_cells[(_head + index) & (N - 1)]._value;}
+
+        constexpr const_pointer slot (size_type index) const {
+            return &_cells[(_head + index) & (N - 1)]._value;}
+
+        // ---------
+        // construct
+        // ---------
+
+        static constexpr void construct (pointer p, const_reference v) {
+            std::construct_at(p, v);}
+
+        // -------
+        // destroy
+        // -------
+
+        static constexpr void destroy (pointer p) {
+            std::destroy_at(p);}
+#else
+        pointer slot (size_type index) {
+            return reinterpret_cast<pointer>(_bytes) + ((_head + index) & (N - 1));}
+
+        const_pointer slot (size_type index) const {
+            return reinterpret_cast<const_pointer>(_bytes) + ((_head + index) & (N - 1));}
+
+        // ---------
+        // construct
+        // ---------
+
+        static void construct (pointer p, const_reference v) {
+            new (p) T(v);}
+
+        // -------
+        // destroy
+        // -------
+
+        static void destroy (pointer p) {
+            p->~T();}
+#endif
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag       iterator_category;
+                typedef typename StaticDeque::value_type      value_type;
+                typedef typename StaticDeque::difference_type difference_type;
+                typedef typename StaticDeque::pointer         pointer;
+                typedef typename StaticDeque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._deque == rhs._deque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+                friend class StaticDeque;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type    _index;
+                StaticDeque* _deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                iterator (size_type index, StaticDeque* deque) : _index(index), _deque(deque) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return *_deque->slot(_index);}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag       iterator_category;
+                typedef typename StaticDeque::value_type      value_type;
+                typedef typename StaticDeque::difference_type difference_type;
+                typedef typename StaticDeque::const_pointer   pointer;
+                typedef typename StaticDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._deque == rhs._deque;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type          _index;
+                const StaticDeque* _deque;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                const_iterator (size_type index, const StaticDeque* deque) : _index(index), _deque(deque) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return *_deque->slot(_index);}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                const_iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                const_iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                const_iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                const_iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        STATIC_DEQUE_CONSTEXPR StaticDeque () : _head(0), _size(0) {
+            assert(valid());}
+
+        /**
+         * @param s the number of elements, at most N
+         * @param v the value to copy into each
+         */
+        explicit StaticDeque (size_type s, const_reference v = value_type()) : _head(0), _size(0) {
+            resize(s, v);
+            assert(valid());}
+
+        StaticDeque (const StaticDeque& that) : _head(0), _size(0) {
+            for (size_type i = 0; i != that._size; ++i)
+                push_back(that[i]);
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        STATIC_DEQUE_CONSTEXPR ~StaticDeque () {
+            clear();}
+
+        // ----------
+        // operator =
+        // ----------
+
+        StaticDeque& operator = (const StaticDeque& rhs) {
+            if (this == &rhs)
+                return *this;
+            const size_type n = std::min(_size, rhs._size);
+            std::copy(rhs.begin(), rhs.begin() + n, begin());
+            while (_size > rhs._size)
+                pop_back();
+            for (size_type i = n; i != rhs._size; ++i)
+                push_back(rhs[i]);
+            assert(valid());
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        STATIC_DEQUE_CONSTEXPR reference operator [] (size_type index) {
+            return *slot(index);}
+
+        STATIC_DEQUE_CONSTEXPR const_reference operator [] (size_type index) const {
+            return *slot(index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        reference at (size_type index) {
+            if (index >= _size)
+                throw std::invalid_argument("StaticDeque::at index out of range");
+            return (*this)[index];}
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        const_reference at (size_type index) const {
+            if (index >= _size)
+                throw std::invalid_argument("StaticDeque::at index out of range");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        STATIC_DEQUE_CONSTEXPR reference back () {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        STATIC_DEQUE_CONSTEXPR const_reference back () const {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        iterator begin () {
+            return iterator(0, this);}
+
+        const_iterator begin () const {
+            return const_iterator(0, this);}
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return N
+         */
+        size_type capacity () const {
+            return N;}
+
+        // -----
+        // clear
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR void clear () {
+            while (_size != 0)
+                pop_back();
+            _head = 0;}
+
+        // -----
+        // empty
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR bool empty () const {
+            return _size == 0;}
+
+        // ---
+        // end
+        // ---
+
+        iterator end () {
+            return iterator(_size, this);}
+
+        const_iterator end () const {
+            return const_iterator(_size, this);}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * shifts the shorter side of i in by one
+         * @return an iterator to the element after the one erased
+         */
+        iterator erase (iterator i) {
+            assert(i._index < _size);
+            if (i._index < _size / 2) {
+                for (size_type k = i._index; k != 0; --k)
+                    (*this)[k] = (*this)[k - 1];
+                pop_front();}
+            else {
+                for (size_type k = i._index; k + 1 != _size; ++k)
+                    (*this)[k] = (*this)[k + 1];
+                pop_back();}
+            return iterator(i._index, this);}
+
+        // -----
+        // front
+        // -----
+
+        STATIC_DEQUE_CONSTEXPR reference front () {
+            assert(!empty());
+            return (*this)[0];}
+
+        STATIC_DEQUE_CONSTEXPR const_reference front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // ----
+        // full
+        // ----
+
+        /**
+         * @return true if another push would exceed N
+         */
+        STATIC_DEQUE_CONSTEXPR bool full () const {
+            return _size == N;}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * shifts the shorter side of i out by one
+         * @return an iterator to the inserted element
+         */
+        iterator insert (iterator i, const_reference v) {
+            assert(i._index <= _size);
+            const value_type t = v;
+            if (i._index == 0) {
+                push_front(t);
+                return begin();}
+            if (i._index < _size / 2) {
+                push_front(front());
+                for (size_type k = 1; k != i._index; ++k)
+                    (*this)[k] = (*this)[k + 1];}
+            else {
+                push_back(t);
+                for (size_type k = _size - 1; k != i._index; --k)
+                    (*this)[k] = (*this)[k - 1];}
+            (*this)[i._index] = t;
+            return iterator(i._index, this);}
+
+        // --------
+        // pop_back
+        // --------
+
+        STATIC_DEQUE_CONSTEXPR void pop_back () {
+            assert(!empty());
+            --_size;
+            destroy(slot(_size));
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        STATIC_DEQUE_CONSTEXPR void pop_front () {
+            assert(!empty());
+            destroy(slot(0));
+            _head = (_head + 1) & (N - 1);
+            --_size;
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        STATIC_DEQUE_CONSTEXPR void push_back (const_reference v) {
+            assert(!full());
+            construct(slot(_size), v);
+            ++_size;
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        STATIC_DEQUE_CONSTEXPR void push_front (const_reference v) {
+            assert(!full());
+            construct(slot(N - 1), v);
+            _head = (_head + N - 1) & (N - 1);
+            ++_size;
+            assert(valid());}
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s the new size, at most N
+         * @param v the value to copy into any new elements
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            assert(s <= N);
+            while (_size > s)
+                pop_back();
+            while (_size < s)
+                push_back(v);}
+
+        // ----
+        // size
+        // ----
+
+        STATIC_DEQUE_CONSTEXPR size_type size () const {
+            return _size;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * swaps the elements one by one, since neither deque owns a pointer to trade
+         */
+        void swap (StaticDeque& that) {
+            StaticDeque& s = (_size < that._size) ? *this : that;
+            StaticDeque& l = (_size < that._size) ? that  : *this;
+            const size_type n = s._size;
+            for (size_type i = 0; i != n; ++i)
+                std::swap(s[i], l[i]);
+            for (size_type i = n; i != l._size; ++i)
+                s.push_back(l[i]);
+            while (l._size != n)
+                l.pop_back();
+            assert(valid());}};
+
+#endif // StaticDeque_h
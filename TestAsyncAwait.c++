@@ -0,0 +1,264 @@
+// ---------------------------------
+// projects/deque/TestAsyncAwait.c++
+// ---------------------------------
+
+/*
+To test the program:
+    % g++ -std=c++20 -pedantic -Wall TestAsyncAwait.c++ -lcppunit -ldl -o TestAsyncAwait.app
+    % valgrind TestAsyncAwait.app >& TestAsyncAwait.out
+*/
+
+// --------
+// includes
+// --------
+
+#include <iostream> // ios_base, cout, endl
+#include <memory>   // allocator
+#include <string>   // string
+#include <utility>  // pair
+#include <vector>   // vector
+
+#include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
+#include "cppunit/TestFixture.h"             // TestFixture
+#include "cppunit/TextTestRunner.h"          // TestRunner
+
+#include "ArenaAllocator.h"
+#include "AsyncAwait.h"
+#include "CompressedDeque.h"
+#include "DequePool.h"
+#include "KeyedDeque.h"
+#include "MemoryBudget.h"
+#include "MonotonicDeque.h"
+#include "SpillDeque.h"
+#include "StaticDeque.h"
+#include "TieredVector.h"
+#include "WindowAggregator.h"
+
+// --------------
+// instantiations
+// --------------
+
+/**
+ * the key of a pair, for KeyedDeque
+ */
+struct first_of {
+    typedef int result_type;
+
+    int operator () (const std::pair<int, int>& p) const {
+        return p.first;}};
+
+// Every member of every container must compile as C++20, with the default
+// allocator, with std::allocator named explicitly, and with the repo's own.
+
+template class Deque<int>;
+template class Deque<std::string, std::allocator<std::string> >;
+template class Deque<int, ArenaAllocator<int> >;
+template class Deque<int, BudgetAllocator<int> >;
+template class Deque<bool>;
+template class AsyncDeque<int>;
+template class CompressedDeque<long>;
+template class DequePool<int>;
+template class KeyedDeque<std::pair<int, int>, first_of>;
+template class MonotonicDeque<int>;
+template class SpillDeque<int>;
+template class StaticDeque<std::string, 16>;
+template class TieredVector<int, std::allocator<int> >;
+template class WindowAggregator<int>;
+
+// ---------------------
+// constant StaticDeques
+// ---------------------
+
+/**
+ * pushes and pops at both ends of a StaticDeque, wrapping its head, all at compile time
+ * @return the elements left, as decimal digits, front first
+ */
+constexpr int static_deque_digits () {
+    StaticDeque<int, 4> x;
+    x.push_back(2);
+    x.push_back(3);
+    x.push_front(1);
+    x.push_back(4);
+    x.pop_front();
+    x.push_back(5);
+    x.pop_back();
+    x[0] = 6;
+    int n = 0;
+    for (std::size_t i = 0; i != x.size(); ++i)
+        n = 10 * n + x[i];
+    return n;}
+
+static_assert(static_deque_digits() == 634, "StaticDeque in a constant expression");
+
+/**
+ * the same with an element that owns memory, so that each pop must destroy it
+ */
+constexpr std::size_t static_deque_lengths () {
+    StaticDeque<std::string, 2> x;
+    x.push_front(std::string(40, 'a'));
+    x.push_back(std::string(50, 'b'));
+    x.pop_front();
+    x.push_front(std::string(60, 'c'));
+    return x.front().size() + x.back().size();}
+
+static_assert(static_deque_lengths() == 110, "StaticDeque of string in a constant expression");
+
+// --------------
+// TestAsyncAwait
+// --------------
+
+struct TestAsyncAwait : CppUnit::TestFixture {
+    typedef AsyncDeque<int> Q;
+
+    // ------
+    // stages
+    // ------
+
+    static Stage produce (Q& q, int b, int e, int& suspended) {
+        for (int i = b; i != e; ++i) {
+            const bool full = (q.size() == q.bound());
+            co_await async_push_back(q, i);
+            suspended += full;}}
+
+    static Stage consume (Q& q, int n, std::vector<int>& seen) {
+        for (int i = 0; i != n; ++i)
+            seen.push_back(co_await async_pop_front(q));}
+
+    // --------------
+    // test_await_pop
+    // --------------
+
+    void test_await_pop () {
+        Executor         e;
+        Q                q(e, 4);
+        std::vector<int> seen;
+        int              s = 0;
+        consume(q, 2, seen);
+        assert(seen.empty());
+        assert(q.waiting_consumers() == 1);
+        produce(q, 7, 8, s);
+        assert(seen.empty());
+        assert(q.empty());
+        assert(e.run() == 1);
+        assert(seen.size() == 1);
+        assert(seen[0] == 7);
+        assert(q.waiting_consumers() == 1);
+        produce(q, 8, 9, s);
+        assert(e.run() == 1);
+        assert(seen.size() == 2);
+        assert(seen[1] == 8);
+        assert(q.waiting_consumers() == 0);
+        assert(s == 0);}
+
+    // ---------------
+    // test_await_push
+    // ---------------
+
+    void test_await_push () {
+        Executor         e;
+        Q                q(e, 2);
+        int              s = 0;
+        produce(q, 0, 5, s);
+        assert(q.size() == 2);
+        assert(q.waiting_producers() == 1);
+        std::vector<int> seen;
+        consume(q, 5, seen);
+        e.run();
+        assert(seen.size() == 5);
+        for (int i = 0; i != 5; ++i)
+            assert(seen[i] == i);
+        assert(s != 0);
+        assert(q.empty());}
+
+    // ----------------
+    // test_await_batch
+    // ----------------
+
+    void test_await_batch () {
+        Executor         e;
+        Q                q(e, 16);
+        std::vector<int> seen;
+        for (int k = 0; k != 8; ++k)
+            consume(q, 1, seen);
+        assert(q.waiting_consumers() == 8);
+        const int v[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        assert(q.push_back(v, v + 10) == v + 10);
+        assert(q.waiting_consumers() == 0);
+        assert(q.size() == 2);
+        assert(e.run() == 8);
+        assert(seen.size() == 8);
+        for (int i = 0; i != 8; ++i)
+            assert(seen[i] == i);}
+
+    // -----------------
+    // test_await_stages
+    // -----------------
+
+    void test_await_stages () {
+        Executor         e;
+        Q                q(e, 3);
+        std::vector<int> seen;
+        int              s = 0;
+        consume(q, 1000, seen);
+        produce(q, 0,   500,  s);
+        produce(q, 500, 1000, s);
+        e.run();
+        assert(seen.size() == 1000);
+        long sum = 0;
+        for (int i = 0; i != 1000; ++i)
+            sum += seen[i];
+        assert(sum == 999L * 1000 / 2);
+        assert(q.empty());
+        assert(q.waiting_consumers() == 0);
+        assert(q.waiting_producers() == 0);}
+
+    // ---------------
+    // test_containers
+    // ---------------
+
+    void test_containers () {
+        Deque<int, std::allocator<int> > x(30, 1);
+        Deque<int>                       y;
+        x.splice_back(y);
+        assert(x.size() == 30);
+        MonotonicDeque<int> m;
+        m.push_back(3);
+        m.push_back(1);
+        assert(m.front() == 1);
+        SpillDeque<int> s(2);
+        for (int i = 0; i != 5000; ++i)
+            s.push_back(i);
+        assert(s.front() == 0);
+        KeyedDeque<std::pair<int, int>, first_of> k;
+        k.push_back(std::make_pair(1, 2));
+        assert(k.lower_bound(1) == 0);
+        TieredVector<int> t(100, 4);
+        assert(t.at(99) == 4);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestAsyncAwait);
+    CPPUNIT_TEST(test_await_pop);
+    CPPUNIT_TEST(test_await_push);
+    CPPUNIT_TEST(test_await_batch);
+    CPPUNIT_TEST(test_await_stages);
+    CPPUNIT_TEST(test_containers);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----
+// main
+// ----
+
+int main () {
+    using namespace std;
+    ios_base::sync_with_stdio(false);  // turn off synchronization with C I/O
+    cout << "TestAsyncAwait.c++" << endl;
+
+    CppUnit::TextTestRunner tr;
+    tr.addTest(TestAsyncAwait::suite());
+    tr.run();
+
+    cout << "Done." << endl;
+    return 0;}
@@ -14,16 +14,36 @@ To test the program:
 // includes
 // --------
 
-#include <algorithm> // copy, count, fill, reverse
-#include <deque>     // deque
-#include <memory>    // allocator
+#include <algorithm>  // copy, count, fill, find, max_element, min, min_element, reverse
+#include <cstddef>    // size_t
+#include <deque>      // deque
+#include <functional> // greater, unary_function
+#include <limits>     // numeric_limits
+#include <memory>     // allocator
+#include <stdexcept>  // invalid_argument
+#include <string>     // string
+#include <utility>    // pair
+#include <vector>     // vector
+
+#include <pthread.h> // pthread_create, pthread_join
 
 #include "cppunit/extensions/HelperMacros.h" // CPPUNIT_TEST, CPPUNIT_TEST_SUITE, CPPUNIT_TEST_SUITE_END
 #include "cppunit/TestFixture.h"             // TestFixture
 #include "cppunit/TestSuite.h"               // TestSuite
 #include "cppunit/TextTestRunner.h"          // TestRunner
 
+#include "ArenaAllocator.h"
+#include "AsyncDeque.h"
+#include "CompressedDeque.h"
 #include "Deque.h"
+#include "DequePool.h"
+#include "KeyedDeque.h"
+#include "MemoryBudget.h"
+#include "MonotonicDeque.h"
+#include "SpillDeque.h"
+#include "StaticDeque.h"
+#include "TieredVector.h"
+#include "WindowAggregator.h"
 
 // ---------
 // TestDeque
@@ -143,7 +163,11 @@ struct TestDeque : CppUnit::TestFixture {
         const C y(10, 2);
         typename C::iterator       p = x.end();
         typename C::const_iterator q = y.end();
-        assert(*p == *q);}
+        --p;
+        --q;
+        assert(*p == *q);
+        assert(++p == x.end());
+        assert(++q == y.end());}
 
     // ----------
     // test_erase
@@ -289,6 +313,1598 @@ struct TestDeque : CppUnit::TestFixture {
     CPPUNIT_TEST(test_algorithms);
     CPPUNIT_TEST_SUITE_END();};
 
+// ---------------
+// TestDequeSplice
+// ---------------
+
+struct TestDequeSplice : CppUnit::TestFixture {
+    typedef Deque<int> C;
+
+    // ----
+    // iota
+    // ----
+
+    static C iota (int b, int e) {
+        C x;
+        while (b != e)
+            x.push_back(b++);
+        return x;}
+
+    // ----------------
+    // test_splice_back
+    // ----------------
+
+    void test_splice_back () {
+        for (int n = 0; n != 25; ++n)
+            for (int m = 0; m != 25; ++m) {
+                C x = iota(0, n);
+                C y = iota(n, n + m);
+                x.splice_back(y);
+                assert(x == iota(0, n + m));
+                assert(y.empty());
+                y.push_back(1);
+                assert(y.size() == 1);}}
+
+    // -----------------
+    // test_splice_front
+    // -----------------
+
+    void test_splice_front () {
+        for (int n = 0; n != 25; ++n)
+            for (int m = 0; m != 25; ++m) {
+                C x = iota(m, m + n);
+                C y = iota(0, m);
+                x.splice_front(y);
+                assert(x == iota(0, n + m));
+                assert(y.empty());}}
+
+    // ------------------
+    // test_splice_seam
+    // ------------------
+
+    void test_splice_seam () {
+        C x(20, 2);
+        C y(20, 3);
+        x.splice_back(y);
+        assert(x.size() == 40);
+        assert(std::count(x.begin(), x.end(), 3) == 20);
+        x.push_back(4);
+        x.push_front(1);
+        assert(x.front() == 1);
+        assert(x.back()  == 4);}
+
+    // -------------------
+    // test_splice_realign
+    // -------------------
+
+    void test_splice_realign () {
+        typedef Deque<std::string> S;
+        for (int n = 1; n != 35; ++n)
+            for (int m = 1; m != 35; ++m)
+                for (int f = 0; f != 12; f += 3) {
+                    S x;
+                    S y;
+                    for (int i = 0; i != f; ++i)
+                        x.push_back("pad");
+                    for (int i = 0; i != n; ++i)
+                        x.push_back(std::string(20, char('a' + i)));
+                    for (int i = 0; i != f; ++i)
+                        x.pop_front();
+                    for (int i = 0; i != m; ++i)
+                        y.push_back(std::string(20, char('A' + i)));
+                    x.splice_back(y);
+                    assert(x.size() == std::size_t(n + m));
+                    assert(y.empty());
+                    for (int i = 0; i != n; ++i)
+                        assert(x[i] == std::string(20, char('a' + i)));
+                    for (int i = 0; i != m; ++i)
+                        assert(x[n + i] == std::string(20, char('A' + i)));}}
+
+    // -----------------
+    // test_splice_throw
+    // -----------------
+
+    void test_splice_throw () {
+        typedef Deque<std::string, BudgetAllocator<std::string> > B;
+        const std::string            v(40, 'v');
+        MemoryBudget                 m(1 << 20);
+        BudgetAllocator<std::string> a(m);
+        B                            x(a);
+        B                            y(a);
+        for (int i = 0; i != 20; ++i)
+            x.push_back(v);
+        for (int i = 20; i != 200; ++i)
+            y.push_back(v + char(i));
+        const std::size_t k = m.available();
+        assert(m.charge(k));
+        try {
+            x.splice_back(y);
+            assert(false);}
+        catch (const BudgetExceeded&) {}
+        assert(x.size() == 20);
+        assert(y.size() == 180);
+        assert((x.back() == v) && (y.front() == v + char(20)));
+        m.release(k);
+        x.splice_back(y);
+        assert(y.empty());
+        for (int i = 20; i != 200; ++i)
+            assert(x[i] == v + char(i));}
+
+    // -------------
+    // test_split_at
+    // -------------
+
+    void test_split_at () {
+        for (int n = 0; n != 35; ++n)
+            for (int i = 0; i <= n; ++i) {
+                C x = iota(0, n);
+                C y(3, 7);
+                x.split_at(x.begin() + i, y);
+                assert(x == iota(0, i));
+                assert(y == iota(i, n));
+                x.splice_back(y);
+                assert(x == iota(0, n));}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestDequeSplice);
+    CPPUNIT_TEST(test_splice_back);
+    CPPUNIT_TEST(test_splice_front);
+    CPPUNIT_TEST(test_splice_seam);
+    CPPUNIT_TEST(test_splice_realign);
+    CPPUNIT_TEST(test_splice_throw);
+    CPPUNIT_TEST(test_split_at);
+    CPPUNIT_TEST_SUITE_END();};
+
+// --------------
+// TestDequeShare
+// --------------
+
+struct TestDequeShare : CppUnit::TestFixture {
+    typedef Deque<int> C;
+
+    // ------
+    // shares
+    // ------
+
+    static bool shares (const C& x, const C& y, C::size_type i) {
+        return &x[i] == &y[i];}
+
+    // ----------------------
+    // test_share_constructor
+    // ----------------------
+
+    void test_share_constructor () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        const C y = x;
+        assert(y.copy_on_write());
+        assert(x == y);
+        assert(shares(x, y, 0));
+        assert(shares(x, y, 24));}
+
+    // ---------------------
+    // test_share_assignment
+    // ---------------------
+
+    void test_share_assignment () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y(5, 3);
+        y = x;
+        assert(x == y);
+        assert(shares(x, y, 12));}
+
+    // --------------------
+    // test_share_subscript
+    // --------------------
+
+    void test_share_subscript () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y = x;
+        y[12] = 3;
+        assert(x[12] == 2);
+        assert(y[12] == 3);
+        assert(!shares(x, y, 12));
+        assert( shares(x, y, 0));
+        assert( shares(x, y, 24));}
+
+    // -------------------
+    // test_share_iterator
+    // -------------------
+
+    void test_share_iterator () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y = x;
+        std::fill(y.begin(), y.end(), 3);
+        assert(std::count(x.begin(), x.end(), 2) == 25);
+        assert(std::count(y.begin(), y.end(), 3) == 25);}
+
+    // ---------------
+    // test_share_push
+    // ---------------
+
+    void test_share_push () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y = x;
+        y.push_back(3);
+        y.push_front(3);
+        x.push_back(4);
+        assert(x.size() == 26);
+        assert(y.size() == 27);
+        assert(x.back()  == 4);
+        assert(y.back()  == 3);
+        assert(y.front() == 3);
+        const C& cx = x;
+        const C& cy = y;
+        assert(&cx[12] == &cy[13]);}
+
+    // --------------
+    // test_share_pop
+    // --------------
+
+    void test_share_pop () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y = x;
+        while (!y.empty())
+            y.pop_front();
+        assert(x == C(25, 2));
+        y = x;
+        while (!y.empty())
+            y.pop_back();
+        assert(x == C(25, 2));}
+
+    // --------------
+    // test_share_off
+    // --------------
+
+    void test_share_off () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        C y = x;
+        y.set_copy_on_write(false);
+        assert(x == y);
+        assert(!shares(x, y, 12));
+        const C z = y;
+        assert(!shares(y, z, 12));}
+
+    // ---------------------
+    // test_share_stale_refs
+    // ---------------------
+
+    void test_share_stale_refs () {
+        C x(25, 2);
+        x.set_copy_on_write(true);
+        const int* const r = &x[12];
+        const C y = x;
+        assert(r == &y[12]);
+        x[12] = 3;
+        assert(&x[12] != r);
+        assert(*r   == 2);
+        assert(y[12] == 2);
+        C::iterator i = x.begin();
+        const C z = x;
+        assert(&*i == &x[0]);
+        assert(&*i != &z[0]);
+        *i = 4;
+        assert(z[0] == 2);
+        assert(x[0] == 4);}
+
+    // ------------------
+    // test_share_threads
+    // ------------------
+
+    typedef Deque<std::string> S;
+
+    /**
+     * a snapshot and what it should hold, for a reporting thread
+     */
+    struct Report {
+        S*          snapshot;
+        std::size_t length;};
+
+    static void* report (void* p) {
+        Report* const r = static_cast<Report*>(p);
+        const S&      s = *r->snapshot;
+        std::size_t   n = 0;
+        for (S::const_iterator i = s.begin(); i != s.end(); ++i)
+            n += i->size();
+        r->length -= n;
+        delete r->snapshot;
+        return 0;}
+
+    void test_share_threads () {
+        S x;
+        x.set_copy_on_write(true);
+        for (int i = 0; i != 500; ++i)
+            x.push_back(std::string(20 + i % 7, 'x'));
+        for (int k = 0; k != 50; ++k) {
+            Report r = {new S(x), 0};
+            for (S::size_type i = 0; i != x.size(); ++i)
+                r.length += x[i].size();
+            pthread_t t;
+            assert(pthread_create(&t, 0, report, &r) == 0);
+            for (S::size_type i = k % 7; i < x.size(); i += 7)
+                x[i] += 'y';
+            x.push_back(std::string(30, 'z'));
+            x.pop_front();
+            assert(pthread_join(t, 0) == 0);
+            assert(r.length == 0);}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestDequeShare);
+    CPPUNIT_TEST(test_share_constructor);
+    CPPUNIT_TEST(test_share_assignment);
+    CPPUNIT_TEST(test_share_subscript);
+    CPPUNIT_TEST(test_share_iterator);
+    CPPUNIT_TEST(test_share_push);
+    CPPUNIT_TEST(test_share_pop);
+    CPPUNIT_TEST(test_share_off);
+    CPPUNIT_TEST(test_share_stale_refs);
+    CPPUNIT_TEST(test_share_threads);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----------
+// TestWindow
+// ----------
+
+struct TestWindow : CppUnit::TestFixture {
+    // ------------------------
+    // test_monotonic_deque_min
+    // ------------------------
+
+    void test_monotonic_deque_min () {
+        MonotonicDeque<int> x;
+        std::deque<int>     y;
+        for (int i = 0; i != 500; ++i) {
+            x.push_back((i * 7919) % 101);
+            y.push_back((i * 7919) % 101);
+            if (y.size() > 37) {
+                x.pop_front();
+                y.pop_front();}
+            assert(x.size()  == y.size());
+            assert(x.front() == *std::min_element(y.begin(), y.end()));}}
+
+    // ------------------------
+    // test_monotonic_deque_max
+    // ------------------------
+
+    void test_monotonic_deque_max () {
+        MonotonicDeque< int, std::greater<int> > x;
+        std::deque<int>                          y;
+        for (int i = 0; i != 500; ++i) {
+            x.push_back((i * 7919) % 13);
+            y.push_back((i * 7919) % 13);
+            while (y.size() > std::size_t(i % 17)) {
+                x.pop_front();
+                y.pop_front();}
+            assert(x.empty() == y.empty());
+            if (!y.empty())
+                assert(x.front() == *std::max_element(y.begin(), y.end()));}}
+
+    // ----------------------
+    // test_window_aggregator
+    // ----------------------
+
+    void test_window_aggregator () {
+        WindowAggregator<int>             x;
+        WindowAggregator< int, Min<int> > y;
+        std::deque<int>                   z;
+        assert(x.query() == 0);
+        for (int i = 0; i != 500; ++i) {
+            x.push_back((i * 7919) % 101);
+            y.push_back((i * 7919) % 101);
+            z.push_back((i * 7919) % 101);
+            if (z.size() > 41) {
+                x.pop_front();
+                y.pop_front();
+                z.pop_front();}
+            int s = 0;
+            for (std::size_t j = 0; j != z.size(); ++j)
+                s += z[j];
+            assert(x.query() == s);
+            assert(y.query() == *std::min_element(z.begin(), z.end()));}}
+
+    // ------------------------------
+    // test_window_aggregator_ordered
+    // ------------------------------
+
+    void test_window_aggregator_ordered () {
+        WindowAggregator<std::string> x;
+        x.push_back("a");
+        x.push_back("b");
+        x.push_back("c");
+        assert(x.query() == "abc");
+        x.pop_front();
+        x.push_back("d");
+        assert(x.query() == "bcd");
+        x.pop_front();
+        x.pop_front();
+        x.pop_front();
+        assert(x.empty());
+        assert(x.query() == "");}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestWindow);
+    CPPUNIT_TEST(test_monotonic_deque_min);
+    CPPUNIT_TEST(test_monotonic_deque_max);
+    CPPUNIT_TEST(test_window_aggregator);
+    CPPUNIT_TEST(test_window_aggregator_ordered);
+    CPPUNIT_TEST_SUITE_END();};
+
+// --------------
+// TestAsyncDeque
+// --------------
+
+struct TestAsyncDeque : CppUnit::TestFixture {
+    // -------
+    // Counter
+    // -------
+
+    struct Counter : Continuation {
+        int n;
+
+        Counter () : n(0) {}
+
+        void resume () {
+            ++n;}};
+
+    // --------
+    // Producer
+    // --------
+
+    struct Producer : Continuation {
+        AsyncDeque<int>& q;
+        int              i;
+        int              n;
+
+        Producer (AsyncDeque<int>& q, int n) : q(q), i(0), n(n) {}
+
+        void resume () {
+            while (i != n)
+                if (!q.push_back(i++, *this))
+                    return;}};
+
+    // --------
+    // Consumer
+    // --------
+
+    struct Consumer : Continuation {
+        AsyncDeque<int>&      q;
+        std::vector<int>      seen;
+        int                   slot;
+        bool                  parked;
+
+        explicit Consumer (AsyncDeque<int>& q) : q(q), slot(0), parked(false) {}
+
+        void resume () {
+            if (parked)
+                seen.push_back(slot);
+            while (q.pop_front(slot, *this))
+                seen.push_back(slot);
+            parked = true;}};
+
+    // --------------
+    // test_async_pop
+    // --------------
+
+    void test_async_pop () {
+        Executor        e;
+        AsyncDeque<int> q(e, 4);
+        Counter         k;
+        int             s = 0;
+        assert(!q.pop_front(s, k));
+        assert(q.waiting_consumers() == 1);
+        assert(q.push_back(5, k));
+        assert(s   == 5);
+        assert(k.n == 0);
+        assert(q.empty());
+        assert(e.run() == 1);
+        assert(k.n == 1);
+        assert(q.push_back(6, k));
+        assert(q.pop_front(s, k));
+        assert(s == 6);
+        assert(e.run() == 0);}
+
+    // ---------------
+    // test_async_push
+    // ---------------
+
+    void test_async_push () {
+        Executor        e;
+        AsyncDeque<int> q(e, 2);
+        Counter         k;
+        int             s = 0;
+        assert(q.push_back(1, k));
+        assert(q.push_back(2, k));
+        assert(!q.push_back(3, k));
+        assert(q.waiting_producers() == 1);
+        assert(q.size() == 2);
+        assert(q.pop_front(s, k));
+        assert(s == 1);
+        assert(q.size() == 2);
+        assert(q.waiting_producers() == 0);
+        assert(e.run() == 1);
+        assert(k.n == 1);
+        assert(q.pop_front(s, k) && (s == 2));
+        assert(q.pop_front(s, k) && (s == 3));
+        assert(q.empty());}
+
+    // ----------------
+    // test_async_batch
+    // ----------------
+
+    void test_async_batch () {
+        Executor        e;
+        AsyncDeque<int> q(e, 4);
+        Counter         k[5];
+        int             s[5] = {0};
+        for (int i = 0; i != 5; ++i)
+            assert(!q.pop_front(s[i], k[i]));
+        const int a[] = {10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+        assert(q.push_back(a, a + 10) == a + 9);
+        assert(q.waiting_consumers() == 0);
+        assert(q.size() == 4);
+        for (int i = 0; i != 5; ++i) {
+            assert(s[i]   == 10 + i);
+            assert(k[i].n == 0);}
+        assert(e.run() == 5);
+        for (int i = 0; i != 5; ++i)
+            assert(k[i].n == 1);}
+
+    // -------------------
+    // test_async_pipeline
+    // -------------------
+
+    void test_async_pipeline () {
+        for (int b = 1; b != 6; ++b) {
+            Executor        e;
+            AsyncDeque<int> q(e, b);
+            Consumer        c(q);
+            Producer        p(q, 100);
+            e.post(c);
+            e.post(p);
+            e.run();
+            assert(c.seen.size() == 100);
+            for (int i = 0; i != 100; ++i)
+                assert(c.seen[i] == i);
+            assert(q.empty());
+            assert(q.waiting_consumers() == 1);
+            assert(q.waiting_producers() == 0);}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestAsyncDeque);
+    CPPUNIT_TEST(test_async_pop);
+    CPPUNIT_TEST(test_async_push);
+    CPPUNIT_TEST(test_async_batch);
+    CPPUNIT_TEST(test_async_pipeline);
+    CPPUNIT_TEST_SUITE_END();};
+
+// -------------------
+// TestCompressedDeque
+// -------------------
+
+struct TestCompressedDeque : CppUnit::TestFixture {
+    // ----
+    // same
+    // ----
+
+    template <typename T>
+    static bool same (const CompressedDeque<T>& x, const std::deque<T>& y) {
+        return (x.size() == y.size()) && std::equal(y.begin(), y.end(), x.begin());}
+
+    // -----------------------
+    // test_compressed_history
+    // -----------------------
+
+    void test_compressed_history () {
+        CompressedDeque<long> x;
+        std::deque<long>      y;
+        long                  v = 1000;
+        for (int i = 0; i != 10000; ++i) {
+            v += (i * 7919) % 17 - 8;
+            x.push_back(v);
+            y.push_back(v);}
+        assert(same(x, y));
+        assert(x.packed_bytes() < y.size());
+        for (int i = 0; i != 1000; ++i) {
+            const std::size_t k = (i * 104729) % y.size();
+            assert(x[k] == y[k]);}
+        assert(x.at(9999) == y.back());
+        try {
+            x.at(10000);
+            assert(false);}
+        catch (std::invalid_argument&) {}}
+
+    // --------------------
+    // test_compressed_ends
+    // --------------------
+
+    void test_compressed_ends () {
+        CompressedDeque<int> x;
+        std::deque<int>      y;
+        for (int i = 0; i != 20000; ++i) {
+            const int r = (i * 7919) % 101;
+            const int v = (i * 31) % 23 - 11;
+            if ((r < 30) || y.empty()) {
+                x.push_back(v);
+                y.push_back(v);}
+            else if (r < 55) {
+                x.push_front(v);
+                y.push_front(v);}
+            else if (r < 75) {
+                x.pop_back();
+                y.pop_back();}
+            else if (r < 95) {
+                x.pop_front();
+                y.pop_front();}
+            else
+                assert(x[y.size() / 2] == y[y.size() / 2]);
+            assert(x.size() == y.size());
+            if (!y.empty()) {
+                assert(x.front() == y.front());
+                assert(x.back()  == y.back());}
+            if (i % 1000 == 0)
+                assert(same(x, y));}
+        assert(same(x, y));}
+
+    // ------------------------
+    // test_compressed_extremes
+    // ------------------------
+
+    void test_compressed_extremes () {
+        CompressedDeque<long> x;
+        std::deque<long>      y;
+        const long            a[] = {std::numeric_limits<long>::min(), std::numeric_limits<long>::max(), 0, -1, 1};
+        for (int i = 0; i != 3000; ++i) {
+            x.push_front(a[i % 5]);
+            y.push_front(a[i % 5]);}
+        for (int i = 0; i != 3000; ++i) {
+            x.push_back(7);
+            y.push_back(7);}
+        assert(same(x, y));
+        const CompressedDeque<long> z = x;
+        assert(same(z, y));}
+
+    // -----------------------
+    // test_compressed_readers
+    // -----------------------
+
+    typedef CompressedDeque<long> L;
+
+    /**
+     * scans and then reads at random a deque of 0, 1, 2, ..., and counts the misses
+     */
+    static void* reader (void* p) {
+        const L& x    = *static_cast<const L*>(p);
+        long     miss = 0;
+        long     i    = 0;
+        for (L::const_iterator b = x.begin(), e = x.end(); b != e; ++b)
+            miss += (*b != i++);
+        for (long k = 0; k != 2000; ++k) {
+            const long j = (k * 104729) % long(x.size());
+            miss += (x[j] != j);}
+        return reinterpret_cast<void*>(miss);}
+
+    void test_compressed_readers () {
+        L x;
+        for (long i = 0; i != 5000; ++i)
+            x.push_back(i);
+        pthread_t t;
+        assert(pthread_create(&t, 0, reader, &x) == 0);
+        void* const mine = reader(&x);
+        void*       theirs;
+        assert(pthread_join(t, &theirs) == 0);
+        assert((mine == 0) && (theirs == 0));
+        L::const_iterator b = x.begin();
+        b += 700;
+        assert(*b == 700);
+        --b;
+        assert(*b == 699);
+        ++b;
+        ++b;
+        assert(*b == 701);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestCompressedDeque);
+    CPPUNIT_TEST(test_compressed_history);
+    CPPUNIT_TEST(test_compressed_ends);
+    CPPUNIT_TEST(test_compressed_extremes);
+    CPPUNIT_TEST(test_compressed_readers);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ------------------
+// TestArenaAllocator
+// ------------------
+
+struct TestArenaAllocator : CppUnit::TestFixture {
+    // -----------------
+    // test_arena_blocks
+    // -----------------
+
+    void test_arena_blocks () {
+        ArenaAllocator<int> a;
+        std::vector<int*>   x;
+        for (int i = 0; i != 1000; ++i) {
+            x.push_back(a.allocate(10));
+            assert(reinterpret_cast<std::size_t>(x.back()) % BlockArena::LINE_BYTES == 0);
+            if (i != 0)
+                assert(x[i] != x[i - 1]);}
+        int* const p = x.back();
+        a.deallocate(p, 10);
+        assert(a.allocate(10) == p);
+        for (int i = 0; i != 1000; ++i)
+            a.deallocate(x[i], 10);}
+
+    // ----------------
+    // test_arena_large
+    // ----------------
+
+    void test_arena_large () {
+        ArenaAllocator<char> a;
+        char* const          p = a.allocate(5000);
+        char* const          q = a.allocate(BlockArena::ARENA_BYTES + 1);
+        assert(reinterpret_cast<std::size_t>(p) % BlockArena::LINE_BYTES == 0);
+        assert(reinterpret_cast<std::size_t>(q) % BlockArena::ARENA_BYTES == 0);
+        q[BlockArena::ARENA_BYTES] = 'a';
+        a.deallocate(q, BlockArena::ARENA_BYTES + 1);
+        a.deallocate(p, 5000);
+        ArenaAllocator<double> b(a);
+        assert(ArenaAllocator<char>(b) == a);}
+
+    // -----------------
+    // test_arena_zeroed
+    // -----------------
+
+    void test_arena_zeroed () {
+        typedef Deque<unsigned, ArenaAllocator<unsigned> > C;
+        {
+        C y(100000, 5);
+        y.pop_back();
+        y.pop_back();
+        y.resize(200000, 6);
+        assert(y[100000] == 6);
+        }
+        C x(150000, 0);
+        assert(std::count(x.begin(), x.end(), 0U) == 150000);
+        x.pop_back();
+        x.pop_back();
+        x.push_back(3);
+        x.resize(300000);
+        assert(x[149998] == 3);
+        assert(std::count(x.begin(), x.end(), 0U) == 299999);
+        x.resize(310000, 7);
+        assert(std::count(x.begin(), x.end(), 7U) == 10000);}
+
+    // ------------------
+    // test_arena_threads
+    // ------------------
+
+    typedef Deque<int, ArenaAllocator<int> > D;
+
+    static void* churn (void* p) {
+        D& x = *static_cast<D*>(p);
+        for (int i = 0; i != 20000; ++i) {
+            x.push_back(i);
+            if (i % 3 == 0)
+                x.pop_front();}
+        return 0;}
+
+    void test_arena_threads () {
+        D         x;
+        D         y;
+        pthread_t t;
+        assert(pthread_create(&t, 0, churn, &x) == 0);
+        churn(&y);
+        assert(pthread_join(t, 0) == 0);
+        assert(x == y);
+        assert(x.size() == 13333);
+        assert(x.back() == 19999);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestArenaAllocator);
+    CPPUNIT_TEST(test_arena_blocks);
+    CPPUNIT_TEST(test_arena_large);
+    CPPUNIT_TEST(test_arena_zeroed);
+    CPPUNIT_TEST(test_arena_threads);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ---------------
+// TestStaticDeque
+// ---------------
+
+struct TestStaticDeque : CppUnit::TestFixture {
+    typedef StaticDeque<std::string, 16> C;
+
+    // ----
+    // same
+    // ----
+
+    static bool same (const C& x, const std::deque<std::string>& y) {
+        return (x.size() == y.size()) && std::equal(y.begin(), y.end(), x.begin());}
+
+    // ---------------
+    // test_static_ops
+    // ---------------
+
+    void test_static_ops () {
+        C                       x;
+        std::deque<std::string> y;
+        for (int i = 0; i != 5000; ++i) {
+            const int         r = (i * 7919) % 97;
+            const std::string v(1, char('a' + i % 26));
+            if (y.empty() || ((r < 40) && (y.size() != 16))) {
+                if (r % 2) {
+                    x.push_back(v);
+                    y.push_back(v);}
+                else {
+                    x.push_front(v);
+                    y.push_front(v);}}
+            else if ((r < 50) && (y.size() != 16)) {
+                const std::size_t k = r % (y.size() + 1);
+                assert(*x.insert(x.begin() + k, v) == v);
+                y.insert(y.begin() + k, v);}
+            else if (r < 60) {
+                const std::size_t k = r % y.size();
+                x.erase(x.begin() + k);
+                y.erase(y.begin() + k);}
+            else if (r < 80) {
+                x.pop_back();
+                y.pop_back();}
+            else {
+                x.pop_front();
+                y.pop_front();}
+            assert(same(x, y));}
+        try {
+            x.at(x.size());
+            assert(false);}
+        catch (std::invalid_argument&) {}}
+
+    // ----------------
+    // test_static_swap
+    // ----------------
+
+    void test_static_swap () {
+        C x(3, "a");
+        C y(11, "b");
+        y.pop_front();
+        y.push_back("c");
+        const C t = x;
+        const C u = y;
+        x.swap(y);
+        assert(x == u);
+        assert(y == t);
+        x = t;
+        assert(x == t);
+        assert(x.full() == false);
+        assert(x.capacity() == 16);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestStaticDeque);
+    CPPUNIT_TEST(test_static_ops);
+    CPPUNIT_TEST(test_static_swap);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----------------
+// TestTieredVector
+// ----------------
+
+struct TestTieredVector : CppUnit::TestFixture {
+    typedef TieredVector<std::string> C;
+
+    // ----
+    // same
+    // ----
+
+    static bool same (const C& x, const std::deque<std::string>& y) {
+        return (x.size() == y.size()) && std::equal(y.begin(), y.end(), x.begin());}
+
+    // ----------------
+    // test_tiered_grow
+    // ----------------
+
+    void test_tiered_grow () {
+        C                       x;
+        std::deque<std::string> y;
+        for (int i = 0; i != 3000; ++i) {
+            const std::string v(1 + i % 7, char('a' + i % 26));
+            const std::size_t k = (i * 7919) % (y.size() + 1);
+            if (i % 3 == 0) {
+                x.push_front(v);
+                y.push_front(v);}
+            else {
+                assert(*x.insert(x.begin() + k, v) == v);
+                y.insert(y.begin() + k, v);}
+            if (i % 97 == 0)
+                assert(same(x, y));}
+        assert(same(x, y));
+        const C z = x;
+        assert(z == x);}
+
+    // ------------------
+    // test_tiered_shrink
+    // ------------------
+
+    void test_tiered_shrink () {
+        C                       x;
+        std::deque<std::string> y;
+        for (int i = 0; i != 3000; ++i) {
+            const std::string v(1 + i % 5, char('a' + i % 26));
+            x.push_back(v);
+            y.push_back(v);}
+        for (int i = 0; !y.empty(); ++i) {
+            const std::size_t k = (i * 104729) % y.size();
+            if (i % 5 == 0) {
+                x.pop_front();
+                y.pop_front();}
+            else if (i % 5 == 1) {
+                x.pop_back();
+                y.pop_back();}
+            else {
+                assert(x.erase(x.begin() + k) == x.begin() + k);
+                y.erase(y.begin() + k);}
+            assert(x.size() == y.size());
+            if (i % 89 == 0)
+                assert(same(x, y));}
+        assert(x.empty());
+        x.push_back("a");
+        assert(x.front() == "a");}
+
+    // ----------------
+    // test_tiered_swap
+    // ----------------
+
+    void test_tiered_swap () {
+        typedef TieredVector<int, BudgetAllocator<int> > B;
+        MemoryBudget m(1 << 20);
+        MemoryBudget n(1 << 20);
+        {
+        B x((BudgetAllocator<int>(m)));
+        B y((BudgetAllocator<int>(n)));
+        for (int i = 0; i != 500; ++i)
+            x.push_back(i);
+        y.push_back(-1);
+        x.swap(y);
+        assert(n.used() > m.used());
+        assert(x.size() == 1);
+        assert(x.front() == -1);
+        assert(y.size() == 500);
+        for (int i = 0; i != 500; ++i)
+            assert(y[i] == i);
+        try {
+            x.at(1);
+            assert(false);}
+        catch (std::invalid_argument&) {}
+        }
+        assert(m.used() == 0);
+        assert(n.used() == 0);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestTieredVector);
+    CPPUNIT_TEST(test_tiered_grow);
+    CPPUNIT_TEST(test_tiered_shrink);
+    CPPUNIT_TEST(test_tiered_swap);
+    CPPUNIT_TEST_SUITE_END();};
+
+// -------------
+// TestDequeBool
+// -------------
+
+struct TestDequeBool : CppUnit::TestFixture {
+    typedef Deque<bool> C;
+
+    // ----
+    // same
+    // ----
+
+    static bool same (const C& x, const std::deque<bool>& y) {
+        return (x.size() == y.size()) && std::equal(y.begin(), y.end(), x.begin());}
+
+    // ---------------
+    // test_bool_proxy
+    // ---------------
+
+    void test_bool_proxy () {
+        C x(100, false);
+        C::reference r = x[70];
+        r = true;
+        assert(x[70]);
+        assert(x.count() == 1);
+        x[3] = x[70];
+        assert(x[3] && !x[4]);
+        r.flip();
+        assert(!x[70]);
+        C::iterator p = x.begin() + 3;
+        *p = false;
+        assert(x.count() == 0);
+        x.front() = true;
+        x.back()  = true;
+        std::reverse(x.begin(), x.end() - 1);
+        assert(x[98] && x[99] && !x[0]);
+        assert(x.count() == 2);}
+
+    // --------------
+    // test_bool_find
+    // --------------
+
+    void test_bool_find () {
+        C                x;
+        std::deque<bool> y;
+        for (int i = 0; i != 1000; ++i) {
+            const bool v = ((i * 7919) % 13) != 0;
+            if (i % 3) {
+                x.push_back(v);
+                y.push_back(v);}
+            else {
+                x.push_front(v);
+                y.push_front(v);}}
+        assert(same(x, y));
+        assert(x.count() == std::size_t(std::count(y.begin(), y.end(), true)));
+        for (std::size_t f = 0; f < y.size(); f += 37) {
+            std::size_t t = f;
+            while ((t != y.size()) && !y[t])
+                ++t;
+            std::size_t u = f;
+            while ((u != y.size()) && y[u])
+                ++u;
+            assert(x.find(true,  f) == t);
+            assert(x.find(false, f) == u);}
+        assert(x.find_first_unset() == std::size_t(std::find(y.begin(), y.end(), false) - y.begin()));
+        const C z(130, true);
+        assert(z.find_first_unset() == 130);
+        assert(z.find(true, 130)    == 130);}
+
+    // --------------
+    // test_bool_bulk
+    // --------------
+
+    void test_bool_bulk () {
+        C                x;
+        std::deque<bool> y;
+        for (int i = 0; i != 200; ++i) {
+            const std::size_t n = (i * 7919) % 150;
+            const bool        v = (i % 3) == 0;
+            switch (i % 4) {
+                case 0:
+                    x.push_back(n, v);
+                    y.insert(y.end(), n, v);
+                    break;
+                case 1:
+                    x.push_front(n, v);
+                    y.insert(y.begin(), n, v);
+                    break;
+                case 2:
+                    x.pop_back(std::min(n, y.size()));
+                    y.erase(y.end() - std::min(n, y.size()), y.end());
+                    break;
+                default:
+                    x.pop_front(std::min(n, y.size()));
+                    y.erase(y.begin(), y.begin() + std::min(n, y.size()));}
+            assert(same(x, y));
+            assert(x.count() == std::size_t(std::count(y.begin(), y.end(), true)));}
+        x.resize(10);
+        x.insert(x.begin() + 4, true);
+        x.erase(x.begin());
+        y.resize(10);
+        y.insert(y.begin() + 4, true);
+        y.erase(y.begin());
+        assert(same(x, y));}
+
+    // ----------------
+    // test_bool_splice
+    // ----------------
+
+    void test_bool_splice () {
+        for (int a = 0; a != 3; ++a)
+            for (int b = 0; b != 3; ++b) {
+                const std::size_t m = 64 * a + (a == 1 ? 5 : 0);
+                const std::size_t n = 64 * b + (b == 2 ? 0 : 7 * b);
+                C                x;
+                C                z;
+                std::deque<bool> y;
+                std::deque<bool> w;
+                for (std::size_t i = 0; i != m; ++i) {
+                    x.push_back(i % 3 == 0);
+                    y.push_back(i % 3 == 0);}
+                for (std::size_t i = 0; i != n; ++i) {
+                    z.push_back(i % 5 == 0);
+                    w.push_back(i % 5 == 0);}
+                C                u = z;
+                std::deque<bool> v = w;
+                x.splice_back(z);
+                y.insert(y.end(), w.begin(), w.end());
+                assert(z.empty());
+                assert(same(x, y));
+                u.splice_front(x);
+                v.insert(v.begin(), y.begin(), y.end());
+                assert(x.empty());
+                assert(same(u, v));
+                const std::size_t k = (m + n) / 2;
+                u.split_at(u.begin() + k, x);
+                assert(same(x, std::deque<bool>(v.begin() + k, v.end())));
+                v.erase(v.begin() + k, v.end());
+                assert(same(u, v));
+                assert(u.count() == std::size_t(std::count(v.begin(), v.end(), true)));}}
+
+    // --------------
+    // test_bool_misc
+    // --------------
+
+    void test_bool_misc () {
+        C x;
+        assert(x.capacity_back() == 0);
+        assert(x.try_push_front(true));
+        assert(x.try_push_back(false));
+        assert(x.try_push_back(true));
+        assert(x.size() == 3);
+        assert(x[0] && !x[1] && x[2]);
+        assert(x.capacity_back() >= 61);
+        assert(x.memory_footprint() > sizeof(x));
+        x.set_copy_on_write(true);
+        assert(x.copy_on_write());
+        const C y = x;
+        x[0] = false;
+        assert(!x[0]);
+        assert(y[0]);
+        try {
+            x.at(3);
+            assert(false);}
+        catch (std::invalid_argument&) {}}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestDequeBool);
+    CPPUNIT_TEST(test_bool_proxy);
+    CPPUNIT_TEST(test_bool_find);
+    CPPUNIT_TEST(test_bool_bulk);
+    CPPUNIT_TEST(test_bool_splice);
+    CPPUNIT_TEST(test_bool_misc);
+    CPPUNIT_TEST_SUITE_END();};
+
+// --------------
+// TestSpillDeque
+// --------------
+
+struct TestSpillDeque : CppUnit::TestFixture {
+    typedef SpillDeque<int> C;
+
+    /**
+     * a POD message, as a buffering queue would hold
+     */
+    struct Message {
+        long id;
+        char body[20];};
+
+    // ---------------
+    // test_spill_fifo
+    // ---------------
+
+    void test_spill_fifo () {
+        C x(2);
+        const int n = 100 * C::BLOCK_SIZE;
+        for (int i = 0; i != n; ++i) {
+            x.push_back(i);
+            assert(x.resident() <= 3 * std::size_t(C::BLOCK_SIZE));}
+        assert(x.size()    == std::size_t(n));
+        assert(x.spilled() >= 97);
+        assert(x.front()   == 0);
+        assert(x.back()    == n - 1);
+        for (int i = 0; i != n; ++i) {
+            assert(x.front() == i);
+            x.pop_front();
+            assert(x.resident() <= 3 * std::size_t(C::BLOCK_SIZE));}
+        assert(x.empty());
+        assert(x.spilled() == 0);}
+
+    // ----------------------
+    // test_spill_interleaved
+    // ----------------------
+
+    void test_spill_interleaved () {
+        SpillDeque<Message> x(3);
+        std::deque<long>    y;
+        long                id = 0;
+        for (int i = 0; i != 200000; ++i) {
+            if ((((i * 7919) % 101) < (((i / 20000) % 2) ? 30 : 70)) || y.empty()) {
+                Message m = {id, "payload"};
+                x.push_back(m);
+                y.push_back(id++);}
+            else {
+                assert(x.front().id == y.front());
+                assert(std::string(x.front().body) == "payload");
+                x.pop_front();
+                y.pop_front();}
+            assert(x.size() == y.size());
+            assert(x.resident() <= 4 * std::size_t(SpillDeque<Message>::BLOCK_SIZE));
+            if (!y.empty())
+                assert(x.back().id == y.back());}
+        while (!y.empty()) {
+            assert(x.front().id == y.front());
+            x.pop_front();
+            y.pop_front();}
+        assert(x.empty());}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestSpillDeque);
+    CPPUNIT_TEST(test_spill_fifo);
+    CPPUNIT_TEST(test_spill_interleaved);
+    CPPUNIT_TEST_SUITE_END();};
+
+// ----------------
+// TestMemoryBudget
+// ----------------
+
+struct TestMemoryBudget : CppUnit::TestFixture {
+    typedef Deque<int, BudgetAllocator<int> > C;
+
+    // -------------
+    // test_capacity
+    // -------------
+
+    void test_capacity () {
+        Deque<int> x;
+        assert(x.capacity_back()  == 0);
+        assert(x.capacity_front() == 0);
+        x.push_back(0);
+        const std::size_t m = x.memory_footprint();
+        assert(m > sizeof(x) + 10 * sizeof(int));
+        for (std::size_t n = x.capacity_back(); n != 0; --n)
+            x.push_back(1);
+        for (std::size_t n = x.capacity_front(); n != 0; --n)
+            x.push_front(2);
+        assert(x.memory_footprint() == m);
+        assert(x.capacity_back()    == 0);
+        assert(x.capacity_front()   == 0);
+        x.push_back(3);
+        assert(x.memory_footprint() > m);
+        assert(x.capacity_back()    == 9);}
+
+    // --------------
+    // test_footprint
+    // --------------
+
+    void test_footprint () {
+        MemoryBudget b(1 << 20);
+        {
+        C x((BudgetAllocator<int>(b)));
+        C y((BudgetAllocator<int>(b)));
+        for (int i = 0; i != 1000; ++i) {
+            x.push_back(i);
+            y.push_front(i);}
+        assert(b.used() == x.memory_footprint() + y.memory_footprint() - 2 * sizeof(C));
+        for (int i = 0; i != 500; ++i) {
+            x.pop_front();
+            y.pop_back();}
+        assert(b.used() == x.memory_footprint() + y.memory_footprint() - 2 * sizeof(C));
+        }
+        assert(b.used() == 0);}
+
+    // ---------------------
+    // test_footprint_shared
+    // ---------------------
+
+    void test_footprint_shared () {
+        MemoryBudget b(1 << 20);
+        {
+        C x((BudgetAllocator<int>(b)));
+        x.set_copy_on_write(true);
+        for (int i = 0; i != 1000; ++i)
+            x.push_back(i);
+        assert(b.used() == x.memory_footprint() - sizeof(C));
+        const C y = x;
+        assert(b.used() == x.memory_footprint() + y.memory_footprint() - 2 * sizeof(C));
+        x[500] = -1;
+        x.push_front(-2);
+        assert(b.used() == x.memory_footprint() + y.memory_footprint() - 2 * sizeof(C));
+        const std::size_t r = b.available() - 8;
+        assert(b.charge(r));
+        assert(x.capacity_back() != 0);
+        assert(!x.try_push_back(1000));
+        assert(x.size() == 1001);
+        assert(static_cast<const C&>(x).back() == 999);
+        b.release(r);
+        assert(x.try_push_back(1000));
+        assert(b.used() == x.memory_footprint() + y.memory_footprint() - 2 * sizeof(C));
+        }
+        assert(b.used() == 0);}
+
+    // -------------
+    // test_try_push
+    // -------------
+
+    void test_try_push () {
+        MemoryBudget b(4096);
+        C            x((BudgetAllocator<int>(b)));
+        int          n = 0;
+        while (x.try_push_back(n))
+            ++n;
+        assert(n > 500);
+        assert(x.size()          == std::size_t(n));
+        assert(x.back()          == n - 1);
+        assert(x.capacity_back() == 0);
+        assert(b.used()          <= b.limit());
+        try {
+            x.push_back(n);
+            assert(false);}
+        catch (const BudgetExceeded&) {}
+        assert(x.size() == std::size_t(n));
+        for (int i = 0; i != 20; ++i)
+            x.pop_front();
+        assert(x.try_push_back(n));
+        assert(x.back() == n);
+        assert(b.used() == x.memory_footprint() - sizeof(C));}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestMemoryBudget);
+    CPPUNIT_TEST(test_capacity);
+    CPPUNIT_TEST(test_footprint);
+    CPPUNIT_TEST(test_footprint_shared);
+    CPPUNIT_TEST(test_try_push);
+    CPPUNIT_TEST_SUITE_END();};
+
+// -------------
+// TestDequePool
+// -------------
+
+struct TestDequePool : CppUnit::TestFixture {
+    // ---------------
+    // test_pool_empty
+    // ---------------
+
+    void test_pool_empty () {
+        typedef DequePool<int*> P;
+        assert(sizeof(P::handle) <= 16);
+        P         p;
+        P::handle x[1000];
+        assert(x[999].empty());
+        assert(p.blocks_used() == 0);
+        int v = 0;
+        p.push_back(x[3], &v);
+        p.push_front(x[3], &v);
+        assert(p.blocks_used() == 2);
+        assert(p.front(x[3]) == &v);
+        p.pop_back(x[3]);
+        p.pop_back(x[3]);
+        assert(x[3].empty());
+        assert(p.blocks_used() == 0);}
+
+    // ---------------
+    // test_pool_mixed
+    // ---------------
+
+    void test_pool_mixed () {
+        DequePool<std::string>                 p;
+        DequePool<std::string>::handle         x[50];
+        std::vector< std::deque<std::string> > y(50);
+        for (int i = 0; i != 40000; ++i) {
+            const std::size_t k = (i * 7919L) % 50;
+            const long        r = (i * 104729L) % 100;
+            const std::string v(1 + i % 7, char('a' + i % 26));
+            if ((r < 30) || y[k].empty()) {
+                p.push_back(x[k], v);
+                y[k].push_back(v);}
+            else if (r < 55) {
+                p.push_front(x[k], v);
+                y[k].push_front(v);}
+            else if (r < 75) {
+                p.pop_back(x[k]);
+                y[k].pop_back();}
+            else {
+                p.pop_front(x[k]);
+                y[k].pop_front();}
+            assert(x[k].size() == y[k].size());
+            if (!y[k].empty()) {
+                assert(p.front(x[k]) == y[k].front());
+                assert(p.back(x[k])  == y[k].back());}}
+        for (std::size_t k = 0; k != 50; ++k) {
+            while (!y[k].empty()) {
+                assert(p.front(x[k]) == y[k].front());
+                p.pop_front(x[k]);
+                y[k].pop_front();}
+            assert(x[k].empty());}
+        assert(p.blocks_used() == 0);}
+
+    // ---------------
+    // test_pool_reuse
+    // ---------------
+
+    void test_pool_reuse () {
+        DequePool<int>         p;
+        DequePool<int>::handle x[100];
+        for (int i = 0; i != 100; ++i)
+            for (int j = 0; j != 40; ++j)
+                p.push_back(x[i], j);
+        const std::size_t m = p.memory_footprint();
+        assert(p.blocks_used() == 100 * ((40 + DequePool<int>::BLOCK_SIZE - 1) / DequePool<int>::BLOCK_SIZE));
+        for (int i = 0; i != 100; ++i)
+            p.clear(x[i]);
+        assert(p.blocks_used() == 0);
+        for (int i = 0; i != 100; ++i)
+            for (int j = 0; j != 40; ++j)
+                p.push_front(x[i], j);
+        assert(p.memory_footprint() == m);
+        assert(p.back(x[7]) == 0);
+        const DequePool<int>& q = p;
+        assert(q.front(x[7]) == 39);
+        assert(q.back(x[7])  == 0);
+        for (int i = 0; i != 100; ++i)
+            p.clear(x[i]);}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestDequePool);
+    CPPUNIT_TEST(test_pool_empty);
+    CPPUNIT_TEST(test_pool_mixed);
+    CPPUNIT_TEST(test_pool_reuse);
+    CPPUNIT_TEST_SUITE_END();};
+
+// --------------
+// TestKeyedDeque
+// --------------
+
+/**
+ * keys a pair by its first member
+ */
+struct first_of : std::unary_function<std::pair<int, int>, int> {
+    int operator () (const std::pair<int, int>& p) const {
+        return p.first;}};
+
+struct TestKeyedDeque : CppUnit::TestFixture {
+    typedef std::pair<int, int>     E;
+    typedef KeyedDeque<E, first_of> K;
+
+    // ----------
+    // test_keyed
+    // ----------
+
+    void test_keyed () {
+        K x;
+        assert(x.lower_bound(0) == 0);
+        assert(x.upper_bound(0) == 0);
+        assert(x.evict_before(5) == 0);
+        const int n = 5 * K::BLOCK_SIZE + 3;
+        for (int i = 0; i != n; ++i)
+            x.push_back(E(i / 3, i));
+        assert(x.size() == size_t(n));
+        assert(x.front() == E(0, 0));
+        assert(x.back()  == E((n - 1) / 3, n - 1));
+        for (int k = 0; k <= (n - 1) / 3; ++k) {
+            assert(x.lower_bound(k) == size_t(3 * k));
+            assert(x.upper_bound(k) == std::min<size_t>(3 * k + 3, n));
+            assert(x[x.lower_bound(k)].first == k);}
+        assert(x.lower_bound(-1) == 0);
+        assert(x.lower_bound(n)  == x.size());
+        assert(x.upper_bound(n)  == x.size());
+        assert(std::count(x.begin(), x.end(), E(7, 22)) == 1);
+        try {
+            x.at(n);
+            assert(false);}
+        catch (std::invalid_argument&) {}}
+
+    // ----------
+    // test_evict
+    // ----------
+
+    void test_evict () {
+        K x;
+        const int n = 4 * K::BLOCK_SIZE;
+        for (int i = 0; i != n; ++i)
+            x.push_back(E(i, i));
+        x.pop_front();
+        x.pop_front();
+        assert(x.lower_bound(1) == 0);
+        assert(x.lower_bound(3) == 1);
+        assert(x.evict_before(K::BLOCK_SIZE + 5) == size_t(K::BLOCK_SIZE + 3));
+        assert(x.front().first == K::BLOCK_SIZE + 5);
+        assert(x.lower_bound(K::BLOCK_SIZE + 7) == 2);
+        assert(x.evict_before(3 * K::BLOCK_SIZE) == size_t(2 * K::BLOCK_SIZE - 5));
+        assert(x.front().first == 3 * K::BLOCK_SIZE);
+        x.pop_back();
+        assert(x.back().first == n - 2);
+        assert(x.evict_before(n) == size_t(K::BLOCK_SIZE - 1));
+        assert(x.empty());
+        x.push_back(E(9, 9));
+        assert(x.upper_bound(9) == 1);
+        x.pop_back();
+        assert(x.empty());}
+
+    // ---------
+    // test_copy
+    // ---------
+
+    void test_copy () {
+        K x;
+        for (int i = 0; i != 3 * K::BLOCK_SIZE; ++i)
+            x.push_back(E(i, -i));
+        x.evict_before(10);
+        K y = x;
+        assert(y == x);
+        y.pop_back();
+        assert(y < x);
+        assert(y != x);
+        y = x;
+        assert(y == x);
+        y.evict_before(3 * K::BLOCK_SIZE);
+        assert(y.empty());
+        assert(x.size() == size_t(3 * K::BLOCK_SIZE - 10));}
+
+    // ----------
+    // test_drain
+    // ----------
+
+    void test_drain () {
+        K x;
+        x.push_back(E(10, 0));
+        x.push_back(E(20, 1));
+        x.pop_front();
+        x.pop_back();
+        assert(x.empty());
+        x.push_back(E(5, 2));
+        assert(x.lower_bound(7)  == 1);
+        assert(x.upper_bound(5)  == 1);
+        assert(x.evict_before(7) == 1);
+        assert(x.empty());
+        for (int i = 0; i != 3 * K::BLOCK_SIZE + 5; ++i)
+            x.push_back(E(100 + i, i));
+        while (!x.empty()) {
+            x.pop_front();
+            if (!x.empty())
+                x.pop_back();}
+        x.push_back(E(9, 0));
+        x.push_back(E(10, 1));
+        assert(x.lower_bound(10) == 1);
+        assert(x.upper_bound(10) == 2);
+        assert(x.evict_before(10) == 1);
+        assert(x.front() == E(10, 1));}
+
+    // -----
+    // suite
+    // -----
+
+    CPPUNIT_TEST_SUITE(TestKeyedDeque);
+    CPPUNIT_TEST(test_keyed);
+    CPPUNIT_TEST(test_evict);
+    CPPUNIT_TEST(test_copy);
+    CPPUNIT_TEST(test_drain);
+    CPPUNIT_TEST_SUITE_END();};
+
 // ----
 // main
 // ----
@@ -299,10 +1915,28 @@ int main () {
     cout << "TestDeque.c++" << endl;
 
     CppUnit::TextTestRunner tr;
-    tr.addTest(TestDeque< std::deque<int>                       >::suite());
-    tr.addTest(TestDeque< std::deque<int, std::allocator<int> > >::suite());
-    tr.addTest(TestDeque<      Deque<int>                       >::suite());
-    tr.addTest(TestDeque<      Deque<int, std::allocator<int> > >::suite());
+    tr.addTest(TestDeque< std::deque<int>                        >::suite());
+    tr.addTest(TestDeque< std::deque<int, std::allocator<int> >  >::suite());
+    tr.addTest(TestDeque<      Deque<int>                        >::suite());
+    tr.addTest(TestDeque<      Deque<int, std::allocator<int> >  >::suite());
+    tr.addTest(TestDeque<      Deque<int, ArenaAllocator<int> >  >::suite());
+    tr.addTest(TestDeque<      StaticDeque<int, 64>              >::suite());
+    tr.addTest(TestDeque<      TieredVector<int>                 >::suite());
+    tr.addTest(TestDeque<      Deque<int, BudgetAllocator<int> > >::suite());
+    tr.addTest(TestDeque<      Deque<bool>                       >::suite());
+    tr.addTest(TestDequeSplice::suite());
+    tr.addTest(TestDequeShare::suite());
+    tr.addTest(TestWindow::suite());
+    tr.addTest(TestAsyncDeque::suite());
+    tr.addTest(TestCompressedDeque::suite());
+    tr.addTest(TestArenaAllocator::suite());
+    tr.addTest(TestStaticDeque::suite());
+    tr.addTest(TestTieredVector::suite());
+    tr.addTest(TestDequeBool::suite());
+    tr.addTest(TestSpillDeque::suite());
+    tr.addTest(TestMemoryBudget::suite());
+    tr.addTest(TestDequePool::suite());
+    tr.addTest(TestKeyedDeque::suite());
     tr.run();
 
     cout << "Done." << endl;
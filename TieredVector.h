@@ -0,0 +1,821 @@
+// -----------------------------
+// projects/deque/TieredVector.h
+// -----------------------------
+
+#ifndef TieredVector_h
+#define TieredVector_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // invalid_argument
+#include <utility>   // !=, <=, >, >=
+
+#include "Deque.h"
+
+// ------------
+// TieredVector
+// ------------
+
+/**
+ * A sequence with O(1) operator [] and O(sqrt(n)) insert and erase anywhere.
+ * The elements live in blocks of B = 2^shift slots, held in a Deque. Every
+ * block but the first and the last is full. Each block is a circular buffer
+ * with its own offset, so moving its first or last element to a neighbor
+ * takes O(1): an insert shifts elements inside one block, then rotates one
+ * element into each block after it, and an erase does the reverse, for
+ * O(B + n / B) in all. B is kept near sqrt(n): it doubles when n passes
+ * 2 * B * B and halves when n falls below B * B / 8, and each rebuild is
+ * paid for by the Theta(n) operations since the last one.
+ * push and pop at either end are amortized O(1).
+ */
+template < typename T, typename A = std::allocator<T> >
+class TieredVector {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef typename classic_allocator<A>::type      allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+        typedef typename allocator_type::pointer         pointer;
+        typedef typename allocator_type::const_pointer   const_pointer;
+
+        typedef typename allocator_type::reference       reference;
+        typedef typename allocator_type::const_reference const_reference;
+
+        /**
+         * a circular buffer of B slots whose logical slot k is data[(offset + k) & (B - 1)]
+         */
+        struct block_type {
+            pointer   data;
+            size_type offset;};
+
+        typedef typename allocator_type::template rebind<block_type>::other block_allocator_type;
+
+        enum {
+            MIN_SHIFT = 4};
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @return true if the two sequences store the same values in the same order, false otherwise
+         */
+        friend bool operator == (const TieredVector& lhs, const TieredVector& rhs) {
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());}
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @return true if the first sequence is lexicographically less than the second, false otherwise
+         */
+        friend bool operator < (const TieredVector& lhs, const TieredVector& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());}
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type _alloc;
+
+        Deque<block_type, block_allocator_type> _blocks;
+
+        size_type _shift;
+
+        /**
+         * the logical slot of the first element in _blocks[0]
+         */
+        size_type _start;
+
+        size_type _size;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_shift >= size_type(MIN_SHIFT))
+                && (_start < block_size())
+                && (_blocks.size() == (_start + _size + block_size() - 1) / block_size());}
+
+        // ----------
+        // block_size
+        // ----------
+
+        size_type block_size () const {
+            return size_type(1) << _shift;}
+
+        // ----
+        // slot
+        // ----
+
+        /**
+         * @param b the index of a block
+         * @param k a logical slot in it
+         * @return the address of that slot
+         */
+        pointer slot (size_type b, size_type k) const {
+            const block_type& x = _blocks[b];
+            return x.data + ((x.offset + k) & (block_size() - 1));}
+
+        /**
+         * @param index a position in this sequence
+         * @return the address of its element
+         */
+        pointer slot (size_type index) const {
+            const size_type g = _start + index;
+            return slot(g >> _shift, g & (block_size() - 1));}
+
+        // ----------
+        // shift_down
+        // ----------
+
+        /**
+         * moves the elements in logical slots (f, l] of block b down by one slot
+         */
+        void shift_down (size_type b, size_type f, size_type l) {
+            const block_type& x = _blocks[b];
+            const size_type   m = block_size() - 1;
+            for (size_type k = f; k != l; ++k)
+                x.data[(x.offset + k) & m] = x.data[(x.offset + k + 1) & m];}
+
+        // --------
+        // shift_up
+        // --------
+
+        /**
+         * moves the elements in logical slots [f, l) of block b up by one slot
+         */
+        void shift_up (size_type b, size_type f, size_type l) {
+            const block_type& x = _blocks[b];
+            const size_type   m = block_size() - 1;
+            for (size_type k = l; k != f; --k)
+                x.data[(x.offset + k) & m] = x.data[(x.offset + k - 1) & m];}
+
+        // ---------
+        // add_block
+        // ---------
+
+        block_type add_block () {
+            block_type x;
+            x.data   = _alloc.allocate(block_size());
+            x.offset = 0;
+            return x;}
+
+        // ------
+        // append
+        // ------
+
+        /**
+         * push_back without the reshape, so reshape can use it
+         */
+        void append (const_reference v) {
+            const size_type e = _start + _size;
+            if (e == (_blocks.size() << _shift))
+                _blocks.push_back(add_block());
+            try {
+                _alloc.construct(slot(_blocks.size() - 1, e & (block_size() - 1)), v);}
+            catch (...) {
+                if ((e & (block_size() - 1)) == 0) {
+                    _alloc.deallocate(_blocks.back().data, block_size());
+                    _blocks.pop_back();}
+                throw;}
+            ++_size;}
+
+        // -------
+        // reshape
+        // -------
+
+        /**
+         * rebuilds this sequence with blocks of 2^s slots if its size has left the range its blocks suit
+         */
+        void reshape () {
+            size_type s = _shift;
+            while (_size > (size_type(2) << (2 * s)))
+                ++s;
+            while ((s > size_type(MIN_SHIFT)) && (_size < ((size_type(1) << (2 * s)) >> 3)))
+                --s;
+            if (s == _shift)
+                return;
+            TieredVector that(_alloc, s);
+            for (size_type i = 0; i != _size; ++i)
+                that.append((*this)[i]);
+            swap(that);}
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * destroys every element and frees every block, leaving this sequence empty
+         */
+        void release () {
+            for (size_type i = 0; i != _size; ++i)
+                _alloc.destroy(slot(i));
+            while (!_blocks.empty()) {
+                _alloc.deallocate(_blocks.back().data, block_size());
+                _blocks.pop_back();}
+            _start = 0;
+            _size  = 0;}
+
+        // -----------
+        // constructor
+        // -----------
+
+        TieredVector (const allocator_type& a, size_type s) :
+                _alloc(a),
+                _blocks(block_allocator_type(a)),
+                _shift(s),
+                _start(0),
+                _size(0) {
+            assert(valid());}
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag        iterator_category;
+                typedef typename TieredVector::value_type      value_type;
+                typedef typename TieredVector::difference_type difference_type;
+                typedef typename TieredVector::pointer         pointer;
+                typedef typename TieredVector::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._vector == rhs._vector;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+                friend class TieredVector;
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type     _index;
+                TieredVector* _vector;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                iterator (size_type index, TieredVector* vector) : _index(index), _vector(vector) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return (*_vector)[_index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::bidirectional_iterator_tag        iterator_category;
+                typedef typename TieredVector::value_type      value_type;
+                typedef typename TieredVector::difference_type difference_type;
+                typedef typename TieredVector::const_pointer   pointer;
+                typedef typename TieredVector::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs._index == rhs._index && lhs._vector == rhs._vector;}
+
+                // ----------
+                // operator +
+                // ----------
+
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;}
+
+                // ----------
+                // operator -
+                // ----------
+
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;}
+
+            private:
+                // ----
+                // data
+                // ----
+
+                size_type           _index;
+                const TieredVector* _vector;
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                const_iterator (size_type index, const TieredVector* vector) : _index(index), _vector(vector) {}
+
+                // Default copy, destructor, and copy assignment.
+
+                // ----------
+                // operator *
+                // ----------
+
+                reference operator * () const {
+                    return (*_vector)[_index];}
+
+                // -----------
+                // operator ->
+                // -----------
+
+                pointer operator -> () const {
+                    return &**this;}
+
+                // -----------
+                // operator ++
+                // -----------
+
+                const_iterator& operator ++ () {
+                    ++_index;
+                    return *this;}
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;}
+
+                // -----------
+                // operator --
+                // -----------
+
+                const_iterator& operator -- () {
+                    --_index;
+                    return *this;}
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;}
+
+                // -----------
+                // operator +=
+                // -----------
+
+                const_iterator& operator += (difference_type d) {
+                    _index += d;
+                    return *this;}
+
+                // -----------
+                // operator -=
+                // -----------
+
+                const_iterator& operator -= (difference_type d) {
+                    _index -= d;
+                    return *this;}};
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit TieredVector (const allocator_type& a = allocator_type()) :
+                _alloc(a),
+                _blocks(block_allocator_type(a)),
+                _shift(MIN_SHIFT),
+                _start(0),
+                _size(0) {
+            assert(valid());}
+
+        /**
+         * @param s the number of elements
+         * @param v the value to copy into each
+         */
+        explicit TieredVector (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                _alloc(a),
+                _blocks(block_allocator_type(a)),
+                _shift(MIN_SHIFT),
+                _start(0),
+                _size(0) {
+            resize(s, v);
+            assert(valid());}
+
+        TieredVector (const TieredVector& that) :
+                _alloc(that._alloc),
+                _blocks(block_allocator_type(that._alloc)),
+                _shift(that._shift),
+                _start(0),
+                _size(0) {
+            try {
+                for (size_type i = 0; i != that._size; ++i)
+                    append(that[i]);}
+            catch (...) {
+                release();
+                throw;}
+            assert(valid());}
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~TieredVector () {
+            release();}
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * copies rhs with this vector's allocator, which it keeps
+         */
+        TieredVector& operator = (const TieredVector& rhs) {
+            if (this == &rhs)
+                return *this;
+            TieredVector that(_alloc);
+            that._shift = rhs._shift;
+            for (size_type i = 0; i != rhs._size; ++i)
+                that.append(rhs[i]);
+            swap(that);
+            return *this;}
+
+        // -----------
+        // operator []
+        // -----------
+
+        reference operator [] (size_type index) {
+            return *slot(index);}
+
+        const_reference operator [] (size_type index) const {
+            return *slot(index);}
+
+        // --
+        // at
+        // --
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        reference at (size_type index) {
+            if (index >= _size)
+                throw std::invalid_argument("TieredVector::at index out of range");
+            return (*this)[index];}
+
+        /**
+         * @throws invalid_argument if index >= size()
+         */
+        const_reference at (size_type index) const {
+            if (index >= _size)
+                throw std::invalid_argument("TieredVector::at index out of range");
+            return (*this)[index];}
+
+        // ----
+        // back
+        // ----
+
+        reference back () {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        const_reference back () const {
+            assert(!empty());
+            return (*this)[_size - 1];}
+
+        // -----
+        // begin
+        // -----
+
+        iterator begin () {
+            return iterator(0, this);}
+
+        const_iterator begin () const {
+            return const_iterator(0, this);}
+
+        // -----
+        // clear
+        // -----
+
+        void clear () {
+            release();
+            _shift = MIN_SHIFT;
+            assert(valid());}
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _size == 0;}
+
+        // ---
+        // end
+        // ---
+
+        iterator end () {
+            return iterator(_size, this);}
+
+        const_iterator end () const {
+            return const_iterator(_size, this);}
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * shifts the rest of i's block down by one, then rotates the first
+         * element of each later block into the end of the block before it
+         * @return an iterator to the element after the one erased
+         */
+        iterator erase (iterator i) {
+            assert(i._index < _size);
+            const size_type m  = block_size() - 1;
+            const size_type g  = _start + i._index;
+            const size_type bt = g >> _shift;
+            const size_type kt = g & m;
+            const size_type e  = _start + _size - 1;
+            const size_type bl = e >> _shift;
+            if (bt == bl) {
+                shift_down(bt, kt, e & m);
+                _alloc.destroy(slot(bt, e & m));}
+            else {
+                shift_down(bt, kt, m);
+                *slot(bt, m) = *slot(bt + 1, 0);
+                for (size_type b = bt + 1; b != bl; ++b) {
+                    _blocks[b].offset = (_blocks[b].offset + 1) & m;
+                    *slot(b, m) = *slot(b + 1, 0);}
+                _alloc.destroy(slot(bl, 0));
+                _blocks[bl].offset = (_blocks[bl].offset + 1) & m;}
+            --_size;
+            if (_size == 0)
+                release();
+            else if ((e & m) == 0) {
+                _alloc.deallocate(_blocks.back().data, block_size());
+                _blocks.pop_back();}
+            reshape();
+            assert(valid());
+            return iterator(i._index, this);}
+
+        // -----
+        // front
+        // -----
+
+        reference front () {
+            assert(!empty());
+            return (*this)[0];}
+
+        const_reference front () const {
+            assert(!empty());
+            return (*this)[0];}
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * shifts the rest of i's block up by one, after rotating the last
+         * element of each block from i's on into the front of the block after it
+         * @return an iterator to the inserted element
+         */
+        iterator insert (iterator i, const_reference v) {
+            assert(i._index <= _size);
+            if (i._index == 0) {
+                push_front(v);
+                return begin();}
+            if (i._index == _size) {
+                push_back(v);
+                return iterator(_size - 1, this);}
+            const value_type t  = v;
+            const size_type  m  = block_size() - 1;
+            const size_type  g  = _start + i._index;
+            const size_type  e  = _start + _size;
+            if (e == (_blocks.size() << _shift))
+                _blocks.push_back(add_block());
+            const size_type  bt = g >> _shift;
+            const size_type  kt = g & m;
+            const size_type  bl = e >> _shift;
+            if (bt == bl) {
+                _alloc.construct(slot(bt, e & m), *slot(bt, (e & m) - 1));
+                shift_up(bt, kt, (e & m) - 1);}
+            else {
+                _blocks[bl].offset = (_blocks[bl].offset - 1) & m;
+                try {
+                    _alloc.construct(slot(bl, 0), *slot(bl - 1, m));}
+                catch (...) {
+                    _blocks[bl].offset = (_blocks[bl].offset + 1) & m;
+                    if ((e & m) == 0) {
+                        _alloc.deallocate(_blocks.back().data, block_size());
+                        _blocks.pop_back();}
+                    throw;}
+                for (size_type b = bl - 1; b != bt; --b) {
+                    _blocks[b].offset = (_blocks[b].offset - 1) & m;
+                    *slot(b, 0) = *slot(b - 1, m);}
+                shift_up(bt, kt, m);}
+            *slot(bt, kt) = t;
+            ++_size;
+            reshape();
+            assert(valid());
+            return iterator(i._index, this);}
+
+        // --------
+        // pop_back
+        // --------
+
+        void pop_back () {
+            assert(!empty());
+            const size_type e = _start + _size - 1;
+            _alloc.destroy(slot(_size - 1));
+            --_size;
+            if (_size == 0)
+                release();
+            else if ((e & (block_size() - 1)) == 0) {
+                _alloc.deallocate(_blocks.back().data, block_size());
+                _blocks.pop_back();}
+            reshape();
+            assert(valid());}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        void pop_front () {
+            assert(!empty());
+            _alloc.destroy(slot(0));
+            --_size;
+            if (_size == 0)
+                release();
+            else if (++_start == block_size()) {
+                _alloc.deallocate(_blocks.front().data, block_size());
+                _blocks.pop_front();
+                _start = 0;}
+            reshape();
+            assert(valid());}
+
+        // ---------
+        // push_back
+        // ---------
+
+        void push_back (const_reference v) {
+            append(v);
+            reshape();
+            assert(valid());}
+
+        // ----------
+        // push_front
+        // ----------
+
+        void push_front (const_reference v) {
+            const bool added = (_start == 0);
+            if (added) {
+                _blocks.push_front(add_block());
+                _start = block_size();}
+            try {
+                _alloc.construct(slot(0, _start - 1), v);}
+            catch (...) {
+                if (added) {
+                    _alloc.deallocate(_blocks.front().data, block_size());
+                    _blocks.pop_front();
+                    _start = 0;}
+                throw;}
+            --_start;
+            ++_size;
+            reshape();
+            assert(valid());}
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s the new size
+         * @param v the value to copy into any new elements
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            while (_size > s)
+                pop_back();
+            while (_size < s)
+                push_back(v);}
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _size;}
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * exchanges the blocks if the allocators are equal, and copies through a temporary if not
+         */
+        void swap (TieredVector& that) {
+            if (_alloc == that._alloc) {
+                _blocks.swap(that._blocks);
+                std::swap(_shift, that._shift);
+                std::swap(_start, that._start);
+                std::swap(_size,  that._size);}
+            else {
+                TieredVector temp(*this);
+                *this = that;
+                that = temp;}
+            assert(valid());}};
+
+#endif // TieredVector_h
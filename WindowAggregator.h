@@ -0,0 +1,171 @@
+// ---------------------------------
+// projects/deque/WindowAggregator.h
+// ---------------------------------
+
+#ifndef WindowAggregator_h
+#define WindowAggregator_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // max, min
+#include <cassert>   // assert
+#include <limits>    // numeric_limits
+#include <memory>    // allocator
+
+#include "Deque.h"
+
+// -------
+// monoids
+// -------
+
+/**
+ * A Monoid is a function object with an associative operator () and an
+ * identity () that operator () leaves unchanged; it need not be commutative.
+ */
+template <typename T>
+struct Sum {
+    T identity () const {
+        return T();}
+
+    T operator () (const T& x, const T& y) const {
+        return x + y;}};
+
+template <typename T>
+struct Min {
+    T identity () const {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();}
+
+    T operator () (const T& x, const T& y) const {
+        return std::min(x, y);}};
+
+template <typename T>
+struct Max {
+    T identity () const {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::min();}
+
+    T operator () (const T& x, const T& y) const {
+        return std::max(x, y);}};
+
+// ----------------
+// WindowAggregator
+// ----------------
+
+/**
+ * A sliding window that answers the aggregate of its values under any monoid in O(1).
+ * This is the two-stacks technique on two Deques: new values go on the back,
+ * with one running aggregate of all of them; the front holds, for each older
+ * value, the aggregate of it and every value after it up to the back. When the
+ * front runs out, the back is folded into it from newest to oldest. Every value
+ * is folded once, so push_back and pop_front are amortized O(1) applications of
+ * the monoid and query() is exactly one.
+ */
+template < typename T, typename M = Sum<T>, typename A = std::allocator<T> >
+class WindowAggregator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T                     value_type;
+        typedef M                     monoid_type;
+        typedef typename A::size_type size_type;
+        typedef const T&              const_reference;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        monoid_type _op;
+
+        Deque<T, A> _front;
+
+        Deque<T, A> _back;
+
+        value_type _back_aggregate;
+
+    private:
+        // ----
+        // flip
+        // ----
+
+        /**
+         * moves the back values to the front, replacing each with the aggregate of it and everything after it
+         */
+        void flip () {
+            value_type a = _op.identity();
+            while (!_back.empty()) {
+                a = _op(_back.back(), a);
+                _front.push_front(a);
+                _back.pop_back();}
+            _back_aggregate = _op.identity();}
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * @param op the monoid used to combine values
+         */
+        explicit WindowAggregator (const monoid_type& op = monoid_type()) : _op(op), _back_aggregate(op.identity()) {}
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----
+        // query
+        // -----
+
+        /**
+         * @return the aggregate of every value in the window, oldest first, or the identity if it is empty
+         */
+        value_type query () const {
+            return _front.empty() ? _back_aggregate : _op(_front.front(), _back_aggregate);}
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * removes the oldest value from the window
+         */
+        void pop_front () {
+            assert(!empty());
+            if (_front.empty())
+                flip();
+            _front.pop_front();}
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v the value to add to the window
+         */
+        void push_back (const_reference v) {
+            _back.push_back(v);
+            _back_aggregate = _op(_back_aggregate, v);}
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return true if the window is empty
+         */
+        bool empty () const {
+            return _front.empty() && _back.empty();}
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return the number of values in the window
+         */
+        size_type size () const {
+            return _front.size() + _back.size();}};
+
+#endif // WindowAggregator_h